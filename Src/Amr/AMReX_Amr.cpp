@@ -467,6 +467,28 @@ Amr::InitAmr ()
 
     loadbalance_max_fac = 1.5;
     pp.query("loadbalance_max_fac", loadbalance_max_fac);
+
+    loadbalance_cost_int = 0;
+    pp.query("loadbalance_cost_int", loadbalance_cost_int);
+
+    loadbalance_cost_threshold = 1.1;
+    pp.query("loadbalance_cost_threshold", loadbalance_cost_threshold);
+
+    loadbalance_particle_cost = 0.0;
+    pp.query("loadbalance_particle_cost", loadbalance_particle_cost);
+
+    loadbalance_cost_strategy = 0;
+    {
+        std::string strategy = "knapsack";
+        pp.query("loadbalance_cost_strategy", strategy);
+        if (strategy == "knapsack") {
+            loadbalance_cost_strategy = 0;
+        } else if (strategy == "sfc") {
+            loadbalance_cost_strategy = 1;
+        } else {
+            amrex::Abort("Amr: amr.loadbalance_cost_strategy must be knapsack or sfc");
+        }
+    }
 }
 
 bool
@@ -857,6 +879,11 @@ Amr::writePlotFile ()
 
 	amrex::Print() << "Write plotfile time = " << dPlotFileTime << "  seconds" << "\n\n";
     }
+    //
+    // Data written by VisMF::AsyncWrite must be on disk on all
+    // processes before the directory is renamed.
+    //
+    VisMF::AsyncWait();
     ParallelDescriptor::Barrier("Amr::writePlotFile::end");
 
     if(ParallelDescriptor::IOProcessor()) {
@@ -982,6 +1009,11 @@ Amr::writeSmallPlotFile ()
 
 	amrex::Print() << "Write small plotfile time = " << dPlotFileTime << "  seconds" << "\n\n";
     }
+    //
+    // Data written by VisMF::AsyncWrite must be on disk on all
+    // processes before the directory is renamed.
+    //
+    VisMF::AsyncWait();
     ParallelDescriptor::Barrier("Amr::writeSmallPlotFile::end");
 
     if(ParallelDescriptor::IOProcessor()) {
@@ -1768,6 +1800,11 @@ Amr::checkPoint ()
 
 	amrex::Print() << "checkPoint() time = " << dCheckPointTime << " secs." << '\n';
     }
+    //
+    // Data written by VisMF::AsyncWrite must be on disk on all
+    // processes before the directory is renamed.
+    //
+    VisMF::AsyncWait();
     ParallelDescriptor::Barrier("Amr::checkPoint::end");
 
     if(ParallelDescriptor::IOProcessor()) {
@@ -1912,6 +1949,8 @@ Amr::timeStep (int  level,
     level_steps[level]++;
     level_count[level]++;
 
+    amr_level[level]->addBoxCostStep();
+
     if (verbose > 0)
     {
 	amrex::Print() << "[Level " << level << " step " << level_steps[level] << "] "
@@ -2019,6 +2058,11 @@ Amr::coarseTimeStep (Real stop_time)
 
     amr_level[0]->postCoarseTimeStep(cumtime);
 
+    if (loadbalance_cost_int > 0 && level_steps[0] % loadbalance_cost_int == 0)
+    {
+        LoadBalanceMeasuredCosts(cumtime);
+    }
+
 #ifdef BL_PROFILING
 #ifdef DEBUG
     std::stringstream dfss;
@@ -2392,7 +2436,7 @@ Amr::regrid (int  lbase,
             new_dmap[lev] = makeLoadBalanceDistributionMap(lev, time, new_grid_places[lev]);
         }
         else if (new_dmap[lev].empty()) {
-	    new_dmap[lev].define(new_grid_places[lev]);
+	    new_dmap[lev] = MakeRegridDistributionMap(lev, new_grid_places[lev]);
 	}
 
         AmrLevel* a = (*levelbld)(*this,lev,Geom(lev),new_grid_places[lev],
@@ -2563,6 +2607,83 @@ Amr::LoadBalanceLevel0 (Real time)
     amr_level[0]->post_regrid(0,time);
 }
 
+void
+Amr::LoadBalanceMeasuredCosts (Real time)
+{
+    BL_PROFILE("LoadBalanceMeasuredCosts()");
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    if (nprocs == 1) return;
+
+    int lmin = -1;
+
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        if (amr_level[lev]->numBoxCostSteps() == 0) continue;
+
+        const Array<Real>& cost = amr_level[lev]->measuredBoxCosts(loadbalance_particle_cost);
+        const BoxArray& ba = boxArray(lev);
+        const DistributionMapping& dm = DistributionMap(lev);
+
+        //
+        // How much more than the average does the busiest process have?
+        //
+        Array<Real> proc_cost(nprocs, 0.0);
+        Real total_cost = 0.0;
+        for (int i = 0; i < cost.size(); ++i) {
+            proc_cost[dm[i]] += cost[i];
+            total_cost += cost[i];
+        }
+        if (total_cost <= 0.0) continue;
+
+        const Real avg_cost = total_cost / nprocs;
+        const Real old_max = *std::max_element(proc_cost.begin(), proc_cost.end());
+
+        if (old_max <= loadbalance_cost_threshold*avg_cost) continue;
+
+        DistributionMapping newdm;
+        if (loadbalance_cost_strategy == 1) {
+            newdm = DistributionMapping::makeSFC(cost, ba);
+        } else {
+            Real navg = static_cast<Real>(ba.size()) / static_cast<Real>(nprocs);
+            int nmax = std::max(std::round(loadbalance_max_fac*navg), std::ceil(navg));
+            newdm = DistributionMapping::makeKnapSack(cost, nmax);
+        }
+
+        std::fill(proc_cost.begin(), proc_cost.end(), 0.0);
+        for (int i = 0; i < cost.size(); ++i) {
+            proc_cost[newdm[i]] += cost[i];
+        }
+        const Real new_max = *std::max_element(proc_cost.begin(), proc_cost.end());
+
+        if (verbose > 0) {
+            amrex::Print() << "Load balance on level " << lev << " at t = " << time
+                           << ": efficiency " << avg_cost/old_max << " -> " << avg_cost/new_max
+                           << (new_max < old_max ? "\n" : ", keeping the old distribution\n");
+        }
+
+        if (new_max < old_max)
+        {
+            InstallNewDistributionMap(lev, newdm);
+            if (lmin < 0) lmin = lev;
+        }
+        else
+        {
+            amr_level[lev]->resetBoxCosts();
+        }
+    }
+
+    //
+    // Let the levels, and their particles, catch up with the new distribution.
+    //
+    if (lmin >= 0)
+    {
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            amr_level[lev]->post_regrid(lmin, finest_level);
+        }
+    }
+}
+
 void
 Amr::InstallNewDistributionMap (int lev, const DistributionMapping& newdm)
 {
@@ -3247,6 +3368,8 @@ Amr::AddProcsToComp(int nSidecarProcs, int prevSidecarProcs) {
         allInts.push_back(loadbalance_with_workestimates);
         allInts.push_back(loadbalance_level0_int);
         allInts.push_back(loadbalance_max_fac);        
+        allInts.push_back(loadbalance_cost_int);
+        allInts.push_back(loadbalance_cost_strategy);
 
 	// ---- these are parmparsed in
         allInts.push_back(plot_nfiles);
@@ -3323,6 +3446,8 @@ Amr::AddProcsToComp(int nSidecarProcs, int prevSidecarProcs) {
         loadbalance_with_workestimates  = allInts[count++];
         loadbalance_level0_int     = allInts[count++];
         loadbalance_max_fac        = allInts[count++];
+        loadbalance_cost_int       = allInts[count++];
+        loadbalance_cost_strategy  = allInts[count++];
 
         plot_nfiles                = allInts[count++];
         mffile_nstreams            = allInts[count++];
@@ -3400,6 +3525,8 @@ Amr::AddProcsToComp(int nSidecarProcs, int prevSidecarProcs) {
         allReals.push_back(check_per);
         allReals.push_back(plot_per);
         allReals.push_back(small_plot_per);
+        allReals.push_back(loadbalance_cost_threshold);
+        allReals.push_back(loadbalance_particle_cost);
 
         for(int i(0); i < dt_level.size(); ++i)   { allReals.push_back(dt_level[i]); }
         for(int i(0); i < dt_min.size(); ++i)     { allReals.push_back(dt_min[i]); }
@@ -3418,6 +3545,8 @@ Amr::AddProcsToComp(int nSidecarProcs, int prevSidecarProcs) {
         check_per  = allReals[count++];
         plot_per   = allReals[count++];
         small_plot_per = allReals[count++];
+        loadbalance_cost_threshold = allReals[count++];
+        loadbalance_particle_cost  = allReals[count++];
 
 	dt_level.resize(dt_level_Size);
         for(int i(0); i < dt_level.size(); ++i)  { dt_level[i] = allReals[count++]; }
@@ -65,6 +65,7 @@ AmrLevel::AmrLevel ()
 {
    parent = 0;
    level = -1;
+   box_cost_nsteps = 0;
 }
 
 AmrLevel::AmrLevel (Amr&            papa,
@@ -354,7 +355,56 @@ AmrLevel::set_state_in_checkpoint (Array<int>& state_in_checkpoint)
 }
 
 void
-AmrLevel::finishConstructor () {}
+AmrLevel::finishConstructor ()
+{
+    resetBoxCosts();
+}
+
+void
+AmrLevel::addBoxCost (int  i,
+                      Real cost)
+{
+    BL_ASSERT(i >= 0 && i < box_cost.size());
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    box_cost[i] += cost;
+}
+
+void
+AmrLevel::resetBoxCosts ()
+{
+    box_cost.assign(grids.size(), 0.0);
+    box_cost_nsteps = 0;
+}
+
+Array<Real>
+AmrLevel::measuredBoxCosts (Real particle_cost) const
+{
+    BL_PROFILE("AmrLevel::measuredBoxCosts()");
+
+    Array<Real> cost(grids.size(), 0.0);
+
+    if (box_cost_nsteps > 0)
+    {
+        for (int i = 0; i < cost.size(); ++i)
+            cost[i] = box_cost[i] / box_cost_nsteps;
+    }
+
+#ifdef USE_PARTICLES
+    if (particle_cost > 0.0)
+    {
+        const Array<long>& np = NumberOfParticlesInGrid();
+        BL_ASSERT(np.empty() || np.size() == cost.size());
+        for (int i = 0; i < np.size(); ++i)
+            cost[i] += particle_cost * np[i];
+    }
+#endif
+
+    ParallelDescriptor::ReduceRealSum(cost.dataPtr(), cost.size());
+
+    return cost;
+}
 
 void
 AmrLevel::setTimeLevel (Real time,
@@ -878,6 +928,10 @@ FillPatchIterator::Initialize (int  boxGrow,
 
     const IndexType& boxType = m_leveldata.boxArray().ixType();
     const int level = m_amrlevel.level;
+    //
+    // The ranges filled from two levels are done together at the end.
+    //
+    Array<AmrLevel::FillPatchRange> two_level_ranges;
 
     for (int i = 0, DComp = 0; i < static_cast<int>(m_range.size()); i++)
     {
@@ -895,7 +949,8 @@ FillPatchIterator::Initialize (int  boxGrow,
 				       m_amrlevel.parent->blockingFactor(m_amrlevel.level),
 				       boxGrow, boxType, desc.interp(SComp)))
 	    {
-		FillFromTwoLevels(time, idx, SComp, DComp, NComp);
+                AmrLevel::FillPatchRange r = { &m_fabs, idx, SComp, DComp, NComp };
+                two_level_ranges.push_back(r);
 	    } else {
 
 #ifdef AMREX_USE_EB
@@ -954,6 +1009,11 @@ FillPatchIterator::Initialize (int  boxGrow,
 
         DComp += NComp;
     }
+
+    if (!two_level_ranges.empty())
+    {
+        m_amrlevel.FillFromTwoLevels(time, two_level_ranges);
+    }
     //
     // Call hack to touch up fillPatched data.
     //
@@ -984,41 +1044,113 @@ FillPatchIterator::FillFromLevel0 (Real time, int idx, int scomp, int dcomp, int
 }
 
 void
-FillPatchIterator::FillFromTwoLevels (Real time, int idx, int scomp, int dcomp, int ncomp)
+AmrLevel::FillFromTwoLevels (Real time, const Array<FillPatchRange>& ranges)
 {
-    int ilev_fine = m_amrlevel.level;
-    int ilev_crse = ilev_fine-1;
+    BL_PROFILE("AmrLevel::FillFromTwoLevels()");
 
-    BL_ASSERT(ilev_crse >= 0);
+    BL_ASSERT(level > 0);
 
-    AmrLevel& fine_level = m_amrlevel;
-    AmrLevel& crse_level = m_amrlevel.parent->getLevel(ilev_crse);
+    AmrLevel&       crse_level = parent->getLevel(level-1);
+    const Geometry& geom_crse  = crse_level.geom;
 
-    const Geometry& geom_fine = fine_level.geom;
-    const Geometry& geom_crse = crse_level.geom;
-    
-    Array<MultiFab*> smf_crse;
-    Array<Real> stime_crse;
-    StateData& statedata_crse = crse_level.state[idx];
-    statedata_crse.getData(smf_crse,stime_crse,time);
-    StateDataPhysBCFunct physbcf_crse(statedata_crse,scomp,geom_crse);
-
-    Array<MultiFab*> smf_fine;
-    Array<Real> stime_fine;
-    StateData& statedata_fine = fine_level.state[idx];
-    statedata_fine.getData(smf_fine,stime_fine,time);
-    StateDataPhysBCFunct physbcf_fine(statedata_fine,scomp,geom_fine);
+    const int N = ranges.size();
 
-    const StateDescriptor& desc = AmrLevel::desc_lst[idx];
+    Array<Array<MultiFab*> > smf_crse(N), smf_fine(N);
+    Array<Array<Real> >      stime_crse(N), stime_fine(N);
+    Array<std::unique_ptr<StateDataPhysBCFunct> > physbcf_crse(N), physbcf_fine(N);
+
+    for (int i = 0; i < N; ++i)
+    {
+        const FillPatchRange& r = ranges[i];
+
+        StateData& statedata_crse = crse_level.state[r.index];
+        statedata_crse.getData(smf_crse[i],stime_crse[i],time);
+        physbcf_crse[i].reset(new StateDataPhysBCFunct(statedata_crse,r.scomp,geom_crse));
+
+        StateData& statedata_fine = state[r.index];
+        statedata_fine.getData(smf_fine[i],stime_fine[i],time);
+        physbcf_fine[i].reset(new StateDataPhysBCFunct(statedata_fine,r.scomp,geom));
+    }
+    //
+    // Ranges into the same layout from fine data of the same layout share
+    // a plan, and so the coarse patch and the pass over it.
+    //
+    Array<int> done(N,0);
+
+    for (int i = 0; i < N; ++i)
+    {
+        if (done[i]) continue;
+
+        const MultiFab& mf  = *ranges[i].mf;
+        const MultiFab& fmf = *smf_fine[i][0];
+
+        Array<int>           group;
+        Array<Interpolater*> mappers;
+
+        for (int j = i; j < N; ++j)
+        {
+            const MultiFab& mfj = *ranges[j].mf;
+
+            if (!done[j]                                            &&
+                mfj.getBDKey()             == mf.getBDKey()         &&
+                mfj.boxArray().ixType()    == mf.boxArray().ixType() &&
+                mfj.nGrow()                == mf.nGrow()            &&
+                smf_fine[j][0]->getBDKey() == fmf.getBDKey())
+            {
+                done[j] = 1;
+                group.push_back(j);
+                mappers.push_back(desc_lst[ranges[j].index].interp(ranges[j].scomp));
+            }
+        }
+
+        FillPatchPlan& plan = getFillPatchPlan(mf, fmf, mappers);
+
+        for (int k = 0; k < group.size(); ++k)
+        {
+            const int j = group[k];
+            const FillPatchRange& r = ranges[j];
+
+            plan.add(*r.mf,
+                     smf_crse[j], stime_crse[j],
+                     smf_fine[j], stime_fine[j],
+                     r.scomp, r.dcomp, r.ncomp,
+                     *physbcf_crse[j], *physbcf_fine[j],
+                     mappers[k], desc_lst[r.index].getBCs());
+        }
+
+        plan.fill(time);
+    }
+}
+
+FillPatchPlan&
+AmrLevel::getFillPatchPlan (const MultiFab& mf, const MultiFab& fmf,
+                            const Array<Interpolater*>& mappers)
+{
+    //
+    // Only the last few are kept.  A level fills into few layouts.  Each
+    // plan holds on to its coarse patch, the coarsened parts of its
+    // destination not covered by the fine data, with all the components
+    // of its largest fill, so a level keeps up to max_plans of these.
+    //
+    static const int max_plans = 8;
+
+    for (int i = 0; i < fillpatch_plans.size(); ++i)
+    {
+        if (fillpatch_plans[i]->isValidFor(mf, fmf, crse_ratio, mappers))
+        {
+            return *fillpatch_plans[i];
+        }
+    }
+
+    if (fillpatch_plans.size() >= max_plans)
+    {
+        fillpatch_plans.erase(fillpatch_plans.begin());
+    }
 
-    amrex::FillPatchTwoLevels(m_fabs, time, 
-			       smf_crse, stime_crse, 
-			       smf_fine, stime_fine,
-			       scomp, dcomp, ncomp, 
-			       geom_crse, geom_fine,
-			       physbcf_crse, physbcf_fine,
-			       crse_level.fineRatio(), 
-			       desc.interp(scomp), desc.getBCs());
+    fillpatch_plans.emplace_back(new FillPatchPlan(mf, fmf, parent->Geom(level-1), geom,
+                                                   crse_ratio, mappers));
+
+    return *fillpatch_plans.back();
 }
 
 static
@@ -2028,11 +2160,176 @@ AmrLevel::FillPatch(AmrLevel& amrlevel,
 {
     BL_ASSERT(dcomp+ncomp-1 <= leveldata.nComp());
     BL_ASSERT(boxGrow <= leveldata.nGrow());
+
+    const BoxArray& ba     = leveldata.boxArray();
+    const BoxArray& old_ba = amrlevel.boxArray();
+
+    if (boxGrow == 0 && ba.ixType().cellCentered() && ba != old_ba)
+    {
+        //
+        // This is how a level is filled from the old one on regrid, when
+        // most of the grids usually stay where they were.  The valid region
+        // of a grid inside an old grid of the same process is just that
+        // data, so take it from there and FillPatch only the other grids.
+        //
+        const DistributionMapping& dm     = leveldata.DistributionMap();
+        const DistributionMapping& old_dm = amrlevel.DistributionMap();
+
+        Array<int> old_idx(ba.size(), -1);
+        BoxList    bl_rest(ba.ixType());
+        Array<int> pmap_rest, idx_rest;
+
+        std::vector< std::pair<int,Box> > isects;
+        for (int i = 0, N = ba.size(); i < N; ++i)
+        {
+            const Box& bx = ba[i];
+            old_ba.intersections(bx, isects);
+            if (isects.size() == 1 && isects[0].second == bx && old_dm[isects[0].first] == dm[i])
+            {
+                old_idx[i] = isects[0].first;
+            }
+            else
+            {
+                bl_rest.push_back(bx);
+                pmap_rest.push_back(dm[i]);
+                idx_rest.push_back(i);
+            }
+        }
+
+        if (idx_rest.size() < ba.size())
+        {
+            Array<MultiFab*> smf;
+            Array<Real> stime;
+            amrlevel.state[index].getData(smf,stime,time);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            for (MFIter mfi(leveldata,true); mfi.isValid(); ++mfi)
+            {
+                const int j = old_idx[mfi.index()];
+                if (j < 0) continue;
+
+                const Box& bx = mfi.tilebox();
+                if (smf.size() == 1) {
+                    leveldata[mfi].copy((*smf[0])[j], bx, scomp, bx, dcomp, ncomp);
+                } else {
+                    leveldata[mfi].linInterp((*smf[0])[j], scomp, (*smf[1])[j], scomp,
+                                             stime[0], stime[1], time, bx, dcomp, ncomp);
+                }
+            }
+
+            if (!idx_rest.empty())
+            {
+                MultiFab rest(BoxArray(bl_rest), DistributionMapping(pmap_rest), ncomp, 0,
+                              MFInfo().SetAlloc(false), leveldata.Factory());
+                FillPatchIterator fpi(amrlevel, rest, 0, time, index, scomp, ncomp);
+                const MultiFab& mf_fillpatched = fpi.get_mf();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+                for (MFIter mfi(mf_fillpatched,true); mfi.isValid(); ++mfi)
+                {
+                    const Box& bx = mfi.tilebox();
+                    leveldata[idx_rest[mfi.index()]].copy(mf_fillpatched[mfi], bx, 0, bx, dcomp, ncomp);
+                }
+            }
+
+            return;
+        }
+    }
+
     FillPatchIterator fpi(amrlevel, leveldata, boxGrow, time, index, scomp, ncomp);
     const MultiFab& mf_fillpatched = fpi.get_mf();
     MultiFab::Copy(leveldata, mf_fillpatched, 0, dcomp, ncomp, boxGrow);
 }
 
+void
+AmrLevel::FillPatch (AmrLevel&               amrlevel,
+                     const Array<MultiFab*>& leveldata,
+                     int                     boxGrow,
+                     Real                    time,
+                     const Array<int>&       index)
+{
+    BL_PROFILE("AmrLevel::FillPatch()");
+
+    BL_ASSERT(leveldata.size() == index.size());
+
+    const int level = amrlevel.level;
+    //
+    // Everything to be filled from two levels goes through one plan
+    // per layout.  Otherwise, and on regrid where FillPatch keeps the
+    // grids that stay, the states are filled one after the other.
+    //
+    bool together = level > 0;
+
+    for (int i = 0; i < leveldata.size() && together; ++i)
+    {
+        const StateDescriptor& desc = desc_lst[index[i]];
+        const BoxArray&        ba   = leveldata[i]->boxArray();
+
+        BL_ASSERT(boxGrow <= leveldata[i]->nGrow());
+
+        together = ba == amrlevel.state[index[i]].boxArray();
+
+        if (together && level > 1)
+        {
+            const std::vector< std::pair<int,int> >& range = desc.sameInterps(0,desc.nComp());
+
+            for (int k = 0, N = range.size(); k < N && together; ++k)
+            {
+                together = amrex::ProperlyNested(amrlevel.crse_ratio,
+                                                 amrlevel.parent->blockingFactor(level),
+                                                 boxGrow, ba.ixType(),
+                                                 desc.interp(range[k].first));
+            }
+        }
+    }
+
+    if (!together)
+    {
+        for (int i = 0; i < leveldata.size(); ++i)
+        {
+            FillPatch(amrlevel, *leveldata[i], boxGrow, time, index[i], 0,
+                      desc_lst[index[i]].nComp());
+        }
+        return;
+    }
+
+    Array<std::unique_ptr<MultiFab> > mf_fillpatched(leveldata.size());
+    Array<FillPatchRange>             ranges;
+
+    for (int i = 0; i < leveldata.size(); ++i)
+    {
+        const StateDescriptor& desc = desc_lst[index[i]];
+
+        mf_fillpatched[i].reset(new MultiFab(leveldata[i]->boxArray(),
+                                             leveldata[i]->DistributionMap(),
+                                             desc.nComp(), boxGrow, MFInfo(),
+                                             leveldata[i]->Factory()));
+
+        const std::vector< std::pair<int,int> >& range = desc.sameInterps(0,desc.nComp());
+
+        for (int k = 0, N = range.size(); k < N; ++k)
+        {
+            FillPatchRange r = { mf_fillpatched[i].get(), index[i],
+                                 range[k].first, range[k].first, range[k].second };
+            ranges.push_back(r);
+        }
+    }
+
+    amrlevel.FillFromTwoLevels(time, ranges);
+
+    for (int i = 0; i < leveldata.size(); ++i)
+    {
+        const int ncomp = desc_lst[index[i]].nComp();
+
+        amrlevel.set_preferred_boundary_values(*mf_fillpatched[i], index[i], 0, 0, ncomp, time);
+
+        MultiFab::Copy(*leveldata[i], *mf_fillpatched[i], 0, 0, ncomp, boxGrow);
+    }
+}
+
 
 
 void
@@ -2,6 +2,7 @@
 #include <AMReX.H>
 #include <AMReX_AmrMesh.H>
 #include <AMReX_Cluster.H>
+#include <AMReX_Interpolater.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_Print.H>
@@ -18,6 +19,8 @@ AmrMesh::Initialize ()
 {
     if (initialized) return;
     initialized = true;
+
+    Interpolater::Initialize();
 }
 
 void
@@ -61,6 +64,10 @@ AmrMesh::InitAmrMesh (int max_level_in, const Array<int>& n_cell_in, std::vector
     use_fixed_upto_level   = 0;
     refine_grid_layout     = true;
     check_input            = true;
+    regrid_remap           = false;
+    distributed_clustering = false;
+    compress_tags          = false;
+    regrid_remap_tolerance = 0.1;
     
     ParmParse pp("amr");
 
@@ -316,6 +323,15 @@ AmrMesh::InitAmrMesh (int max_level_in, const Array<int>& n_cell_in, std::vector
 
     pp.query("check_input", check_input);
 
+    pp.query("regrid_remap", regrid_remap);
+    pp.query("regrid_remap_tolerance", regrid_remap_tolerance);
+
+    // cluster the tags of each process separately instead of gathering them
+    pp.query("distributed_clustering", distributed_clustering);
+
+    // collate and cluster the tags as run-length encoded bitmasks
+    pp.query("compress_tags", compress_tags);
+
     finest_level = -1;
 
     if (check_input) checkInput();
@@ -395,6 +411,332 @@ AmrMesh::MakeBaseGrids () const
 }
 
 
+DistributionMapping
+AmrMesh::MakeRegridDistributionMap (int lev, const BoxArray& ba) const
+{
+    if (regrid_remap)
+    {
+        if (!grids[lev].empty() && !dmap[lev].empty())
+        {
+            return DistributionMapping::makeRemap(ba, grids[lev], dmap[lev], regrid_remap_tolerance);
+        }
+        else if (lev > 0 && !grids[lev-1].empty() && !dmap[lev-1].empty())
+        {
+            // A new level is filled from the one below.
+            BoxArray cba(grids[lev-1]);
+            cba.refine(ref_ratio[lev-1]);
+            return DistributionMapping::makeRemap(ba, cba, dmap[lev-1], regrid_remap_tolerance);
+        }
+    }
+
+    return DistributionMapping(ba);
+}
+
+
+namespace
+{
+    //
+    // The grids of coarsened tags are grown, so they overlap, and a tag in
+    // the overlap may be set in several of them.  It belongs to the lowest
+    // numbered grid only.  Calls f(i, bx) for each local grid i and each
+    // box bx of the cells it owns.
+    //
+    template <class F>
+    void
+    ForEachOwnedBox (const TagBoxArray& tags, F&& f)
+    {
+        const BoxArray& ba = tags.boxArray();
+        std::vector< std::pair<int,Box> > isects;
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+        {
+            const int  i  = mfi.index();
+            const Box& bx = ba[i];
+            BoxList lower;
+            ba.intersections(bx, isects);
+            for (const auto& isec : isects) {
+                if (isec.first < i) lower.push_back(isec.second);
+            }
+            if (lower.isEmpty()) {
+                f(i, bx);
+            } else {
+                for (const Box& b : amrex::complementIn(bx, lower)) f(i, b);
+            }
+        }
+    }
+
+    //
+    // Every process gets the buffers of all processes, in order.
+    //
+    void
+    AllGather (const Array<long>& sendbuf, Array<long>& recvbuf)
+    {
+#ifdef BL_USE_MPI
+        const int nprocs = ParallelDescriptor::NProcs();
+        int nsend = sendbuf.size();
+        Array<int> counts(nprocs), offsets(nprocs, 0);
+        BL_MPI_REQUIRE( MPI_Allgather(&nsend, 1, ParallelDescriptor::Mpi_typemap<int>::type(),
+                                      counts.dataPtr(), 1, ParallelDescriptor::Mpi_typemap<int>::type(),
+                                      ParallelDescriptor::Communicator()) );
+        for (int i = 1; i < nprocs; ++i) {
+            offsets[i] = offsets[i-1] + counts[i-1];
+        }
+        recvbuf.resize(offsets[nprocs-1] + counts[nprocs-1]);
+        BL_MPI_REQUIRE( MPI_Allgatherv(const_cast<long*>(sendbuf.dataPtr()), nsend,
+                                       ParallelDescriptor::Mpi_typemap<long>::type(),
+                                       recvbuf.dataPtr(), counts.dataPtr(), offsets.dataPtr(),
+                                       ParallelDescriptor::Mpi_typemap<long>::type(),
+                                       ParallelDescriptor::Communicator()) );
+#else
+        recvbuf = sendbuf;
+#endif
+    }
+}
+
+//
+// The tags of a process are mostly in a few compact regions, since the grids
+// are mapped along a space filling curve, so clustering them separately costs
+// little in grid efficiency.  The exception is a cluster cut in two by the
+// boundary between two processes.  Hence the merge step: two touching boxes
+// are replaced by their bounding box if that is still efficient, properly
+// nested, and clear of the other boxes.  Every process does the same merge
+// on the same boxes, so they all end up with the same grids.
+//
+void
+AmrMesh::ClusterTagsDistributed (const TagBoxArray& tags, const BoxList& pnd,
+                                 BoxList& new_bx) const
+{
+    BL_PROFILE("AmrMesh::ClusterTagsDistributed()");
+
+    new_bx.clear();
+
+    //
+    // Each tag is taken by one process only, so the tag counts of the
+    // boxes of different processes add up.
+    //
+    Box local_box;
+    ForEachOwnedBox(tags, [&] (int, const Box& bx) {
+        local_box = local_box.ok() ? amrex::minBox(local_box, bx) : bx;
+    });
+
+    std::vector<IntVect> tagvec;
+    TagBitMask           tagmask;
+    ClusterList          clist;
+
+    if (compress_tags)
+    {
+        if (local_box.ok()) tagmask.define(local_box);
+        ForEachOwnedBox(tags, [&] (int i, const Box& bx) {
+            const TagBox& tb = tags[i];
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                if (tb(iv) != TagBox::CLEAR) tagmask.set(iv);
+            }
+        });
+        if (tagmask.numTags() > 0)
+            clist.append(new Cluster(tagmask, tagmask.box()));
+    }
+    else
+    {
+        ForEachOwnedBox(tags, [&] (int i, const Box& bx) {
+            const TagBox& tb = tags[i];
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                if (tb(iv) != TagBox::CLEAR) tagvec.push_back(iv);
+            }
+        });
+        if (tagvec.size() > 0)
+            clist.append(new Cluster(&tagvec[0], tagvec.size()));
+    }
+
+    //
+    // Each box goes out as its corners and its number of tags.
+    //
+    const int nlongs = 2*BL_SPACEDIM + 1;
+    Array<long> sendbuf, recvbuf;
+
+    if (clist.length() > 0)
+    {
+        clist.chop(grid_eff);
+        BoxDomain bd;
+        bd.add(pnd);
+        clist.intersect(bd);
+
+        const BoxList& bl = clist.boxList();
+        const Array<long>& cnt = clist.numTags();
+        int i = 0;
+        for (const Box& bx : bl)
+        {
+            for (int d = 0; d < BL_SPACEDIM; ++d) sendbuf.push_back(bx.smallEnd(d));
+            for (int d = 0; d < BL_SPACEDIM; ++d) sendbuf.push_back(bx.bigEnd(d));
+            sendbuf.push_back(cnt[i++]);
+        }
+    }
+
+    AllGather(sendbuf, recvbuf);
+
+    Array<Box>  boxes;
+    Array<long> ntags;
+    for (int i = 0; i < int(recvbuf.size()); i += nlongs)
+    {
+        const long* p = &recvbuf[i];
+        IntVect lo, hi;
+        for (int d = 0; d < BL_SPACEDIM; ++d) {
+            lo[d] = p[d];
+            hi[d] = p[BL_SPACEDIM+d];
+        }
+        boxes.push_back(Box(lo, hi));
+        ntags.push_back(p[2*BL_SPACEDIM]);
+    }
+
+    if (boxes.empty()) return;
+
+    const BoxArray pnba(pnd);
+
+    for (bool merged = true; merged && boxes.size() > 1; )
+    {
+        merged = false;
+
+        BoxList bl;
+        for (const Box& bx : boxes) bl.push_back(bx);
+        const BoxArray ba(bl);
+
+        const int N = boxes.size();
+        Array<int>  done(N, 0);
+        Array<Box>  new_boxes, bboxes;
+        Array<long> new_ntags;
+        std::vector< std::pair<int,Box> > isects, others;
+
+        for (int i = 0; i < N; ++i)
+        {
+            if (done[i]) continue;
+            done[i] = 1;
+
+            ba.intersections(amrex::grow(boxes[i],1), isects);
+
+            int merge_with = -1;
+            Box bbox;
+            for (const auto& isec : isects)
+            {
+                const int j = isec.first;
+                if (done[j]) continue;
+
+                bbox = amrex::minBox(boxes[i], boxes[j]);
+                if (Real(ntags[i]+ntags[j]) < grid_eff*Real(bbox.numPts())) continue;
+
+                bool clear = true;
+                ba.intersections(bbox, others);
+                for (const auto& o : others) {
+                    if (o.first != i && o.first != j) {
+                        clear = false;
+                        break;
+                    }
+                }
+                for (int k = 0; clear && k < bboxes.size(); ++k) {
+                    if (bboxes[k].intersects(bbox)) clear = false;
+                }
+                if (!clear || !pnba.contains(bbox)) continue;
+
+                merge_with = j;
+                break;
+            }
+
+            if (merge_with >= 0) {
+                done[merge_with] = 1;
+                bboxes.push_back(bbox);
+                new_boxes.push_back(bbox);
+                new_ntags.push_back(ntags[i] + ntags[merge_with]);
+                merged = true;
+            } else {
+                new_boxes.push_back(boxes[i]);
+                new_ntags.push_back(ntags[i]);
+            }
+        }
+
+        boxes.swap(new_boxes);
+        ntags.swap(new_ntags);
+    }
+
+    for (const Box& bx : boxes) new_bx.push_back(bx);
+
+    if (new_bx.isDisjoint()) return;
+
+    //
+    // Clusters of different processes may overlap where their tags do.
+    // Cutting the overlaps away leaves pieces of unknown efficiency, so the
+    // tags in each piece are counted again.  The pieces below grid_eff are
+    // clustered anew, each from its own tags, which are gathered.
+    //
+    new_bx = amrex::removeOverlap(new_bx);
+
+    const BoxArray pieces(new_bx);
+    const int npieces = pieces.size();
+    Array<long> count(npieces, 0);
+    std::vector< std::pair<int,Box> > isects;
+
+    ForEachOwnedBox(tags, [&] (int i, const Box& bx) {
+        const TagBox& tb = tags[i];
+        pieces.intersections(bx, isects);
+        for (const auto& isec : isects) {
+            const Box& b = isec.second;
+            for (IntVect iv = b.smallEnd(); iv <= b.bigEnd(); b.next(iv)) {
+                if (tb(iv) != TagBox::CLEAR) ++count[isec.first];
+            }
+        }
+    });
+    ParallelDescriptor::ReduceLongSum(count.dataPtr(), npieces);
+
+    Array<int> poor(npieces, 0);
+    bool any_poor = false;
+    new_bx.clear();
+    for (int k = 0; k < npieces; ++k)
+    {
+        if (Real(count[k]) >= grid_eff*Real(pieces[k].numPts())) {
+            new_bx.push_back(pieces[k]);
+        } else if (count[k] > 0) {
+            poor[k] = 1;
+            any_poor = true;
+        }
+    }
+
+    if (!any_poor) return;
+
+    //
+    // The tags of the poor pieces go out as the piece and the cell.
+    //
+    sendbuf.clear();
+    ForEachOwnedBox(tags, [&] (int i, const Box& bx) {
+        const TagBox& tb = tags[i];
+        pieces.intersections(bx, isects);
+        for (const auto& isec : isects) {
+            if (!poor[isec.first]) continue;
+            const Box& b = isec.second;
+            for (IntVect iv = b.smallEnd(); iv <= b.bigEnd(); b.next(iv)) {
+                if (tb(iv) != TagBox::CLEAR) {
+                    sendbuf.push_back(isec.first);
+                    for (int d = 0; d < BL_SPACEDIM; ++d) sendbuf.push_back(iv[d]);
+                }
+            }
+        }
+    });
+
+    AllGather(sendbuf, recvbuf);
+
+    Array< std::vector<IntVect> > pts(npieces);
+    for (int i = 0; i < int(recvbuf.size()); i += BL_SPACEDIM+1)
+    {
+        IntVect iv;
+        for (int d = 0; d < BL_SPACEDIM; ++d) iv[d] = recvbuf[i+1+d];
+        pts[recvbuf[i]].push_back(iv);
+    }
+
+    for (int k = 0; k < npieces; ++k)
+    {
+        if (!poor[k]) continue;
+        ClusterList cl(&pts[k][0], pts[k].size());
+        cl.chop(grid_eff);
+        new_bx.join(cl.boxList());
+    }
+}
+
+
 void
 AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Array<BoxArray>& new_grids)
 {
@@ -614,14 +956,53 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Array<BoxArray>& n
         // Remove cells outside proper nesting domain for this level.
         //
         tags.setVal(p_n_comp[levc],TagBox::CLEAR);
-        //
-        // Create initial cluster containing all tagged points.
-        //
-	std::vector<IntVect> tagvec;
-	tags.collate(tagvec);
-        tags.clear();
 
-        if (tagvec.size() > 0)
+        BoxList new_bx;
+
+        if (distributed_clustering)
+        {
+            ClusterTagsDistributed(tags, p_n[levc], new_bx);
+            tags.clear();
+        }
+        else
+        {
+            //
+            // Create initial cluster containing all tagged points.
+            //
+            std::vector<IntVect> tagvec;
+            TagBitMask           tagmask;
+            ClusterList          clist;
+
+            if (compress_tags)
+            {
+                tags.collate(tagmask);
+                if (tagmask.numTags() > 0)
+                    clist.append(new Cluster(tagmask, tagmask.box()));
+            }
+            else
+            {
+                tags.collate(tagvec);
+                if (tagvec.size() > 0)
+                    clist.append(new Cluster(&tagvec[0], tagvec.size()));
+            }
+            tags.clear();
+
+            if (clist.length() > 0)
+            {
+                clist.chop(grid_eff);
+                BoxDomain bd;
+                bd.add(p_n[levc]);
+                clist.intersect(bd);
+                bd.clear();
+                //
+                // Efficient properly nested Clusters have been constructed
+                // now generate list of grids at level levf.
+                //
+                clist.boxList(new_bx);
+            }
+        }
+
+        if (new_bx.size() > 0)
         {
             //
             // Created new level, now generate efficient grids.
@@ -629,21 +1010,6 @@ AmrMesh::MakeNewGrids (int lbase, Real time, int& new_finest, Array<BoxArray>& n
             if ( !(useFixedCoarseGrids() && levc<useFixedUpToLevel()) ) {
                 new_finest = std::max(new_finest,levf);
 	    }
-            //
-            // Construct initial cluster.
-            //
-            ClusterList clist(&tagvec[0], tagvec.size());
-            clist.chop(grid_eff);
-            BoxDomain bd;
-            bd.add(p_n[levc]);
-            clist.intersect(bd);
-            bd.clear();
-            //
-            // Efficient properly nested Clusters have been constructed
-            // now generate list of grids at level levf.
-            //
-            BoxList new_bx;
-            clist.boxList(new_bx);
             new_bx.refine(bf_lev[levc]);
             new_bx.simplify();
             BL_ASSERT(new_bx.isDisjoint());
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <AMReX_Cluster.H>
 #include <AMReX_BoxDomain.H>
+#include <AMReX_TagBox.H>
 
 namespace amrex {
 
@@ -9,16 +10,27 @@ enum CutStatus { HoleCut=0, SteepCut, BisectCut, InvalidCut };
 
 Cluster::Cluster ()
     :
-    m_ar(0) {}
+    m_ar(0),
+    m_mask(0),
+    m_len(0) {}
 
 Cluster::Cluster (IntVect* a, long len)
     :
     m_ar(a),
+    m_mask(0),
     m_len(len)
 {
     minBox();
 }
 
+Cluster::Cluster (const TagBitMask& mask, const Box& bx)
+    :
+    m_bx(mask.minBox(bx)),
+    m_ar(0),
+    m_mask(&mask),
+    m_len(mask.numTags(m_bx))
+{}
+
 Cluster::~Cluster () {}
 
 //
@@ -41,12 +53,22 @@ Cluster::Cluster (Cluster&   c,
                   const Box& b) 
     :
     m_ar(0),
+    m_mask(0),
     m_len(0)
 {
     BL_ASSERT(b.ok());
-    BL_ASSERT(c.m_ar != 0 && c.m_len > 0);
+    BL_ASSERT(c.ok());
 
-    if (b.contains(c.m_bx))
+    if (c.m_mask != 0)
+    {
+        m_mask = c.m_mask;
+        m_bx   = m_mask->minBox(c.m_bx & b);
+        m_len  = m_mask->numTags(m_bx);
+        c.m_len -= m_len;
+        if (c.m_len == 0)
+            c.m_bx = Box();
+    }
+    else if (b.contains(c.m_bx))
     {
         m_bx    = c.m_bx;
         m_ar    = c.m_ar;
@@ -116,6 +138,9 @@ Cluster::distribute (ClusterList&     clst,
 long
 Cluster::numTag (const Box& b) const
 {
+    if (m_mask != 0)
+        return m_mask->numTags(b & m_bx);
+
     long cnt = 0;
     for (int i = 0; i < m_len; i++)
     {
@@ -252,7 +277,7 @@ Cluster*
 Cluster::chop ()
 {
     BL_ASSERT(m_len > 1);
-    BL_ASSERT(!(m_ar == 0));
+    BL_ASSERT(!(m_ar == 0 && m_mask == 0));
 
     const int* lo       = m_bx.loVect();
     const int* hi       = m_bx.hiVect();
@@ -261,20 +286,23 @@ Cluster::chop ()
     //
     // Compute histogram.
     //
-    int* hist[BL_SPACEDIM];
-    for (int n = 0; n < BL_SPACEDIM; n++)
+    Array<int> hist[BL_SPACEDIM];
+    if (m_mask != 0)
     {
-        hist[n] = new int[len[n]];
-        for (int i = 0; i < len[n]; i++)
-            hist[n][i] = 0;
+        m_mask->signature(m_bx, hist);
     }
-    for (int n = 0; n < m_len; n++)
+    else
     {
-        const int* p = m_ar[n].getVect();
-        AMREX_D_TERM( hist[0][p[0]-lo[0]]++;,
-                hist[1][p[1]-lo[1]]++;,
-                hist[2][p[2]-lo[2]]++; )
-     }
+        for (int n = 0; n < BL_SPACEDIM; n++)
+            hist[n].assign(len[n], 0);
+        for (int n = 0; n < m_len; n++)
+        {
+            const int* p = m_ar[n].getVect();
+            AMREX_D_TERM( hist[0][p[0]-lo[0]]++;,
+                    hist[1][p[1]-lo[1]]++;,
+                    hist[2][p[2]-lo[2]]++; )
+        }
+    }
     //
     // Find cutpoint and cutstatus in each index direction.
     //
@@ -283,7 +311,7 @@ Cluster::chop ()
     IntVect cut;
     for (int n = 0; n < BL_SPACEDIM; n++)
     {
-        cut[n] = FindCut(hist[n], lo[n], hi[n], status[n]);
+        cut[n] = FindCut(hist[n].dataPtr(), lo[n], hi[n], status[n]);
         if (status[n] < mincut)
         {
             mincut = status[n];
@@ -316,8 +344,19 @@ Cluster::chop ()
 
     int nhi = m_len - nlo;
 
-    for (int i = 0; i < BL_SPACEDIM; i++)
-        delete [] hist[i];
+    if (m_mask != 0)
+    {
+        Box bxlo(m_bx), bxhi(m_bx);
+        bxlo.setBig(dir, cut[dir]-1);
+        bxhi.setSmall(dir, cut[dir]);
+
+        m_bx  = m_mask->minBox(bxlo);
+        m_len = nlo;
+
+        Cluster* c = new Cluster(*m_mask, bxhi);
+        BL_ASSERT(c->m_len == nhi);
+        return c;
+    }
 
     IntVect* prt_it = std::partition(m_ar, m_ar+m_len, Cut(cut,dir));
 
@@ -410,6 +449,20 @@ ClusterList::boxList (BoxList& blst) const
     }
 }
 
+Array<long>
+ClusterList::numTags () const
+{
+    Array<long> ntags;
+    ntags.reserve(lst.size());
+    for (std::list<Cluster*>::const_iterator cli = lst.begin(), End = lst.end();
+         cli != End;
+         ++cli)
+    {
+        ntags.push_back((*cli)->numTag());
+    }
+    return ntags;
+}
+
 void
 ClusterList::chop (Real eff)
 {
@@ -2,6 +2,7 @@
 #include <AMReX_FillPatchUtil.H>
 #include <AMReX_FillPatchUtil_F.H>
 #include <cmath>
+#include <algorithm>
 
 #ifdef AMREX_USE_EB
 #include <AMReX_EBLevel.H>
@@ -185,6 +186,206 @@ namespace amrex
 	FillPatchSingleLevel(mf, time, fmf, ft, scomp, dcomp, ncomp, fgeom, fbc);
     }
 
+    namespace {
+        //
+        // The coarse box that has what each of the interpolaters needs.
+        //
+        class UnionBoxCoarsener
+            : public BoxConverter
+        {
+        public:
+            UnionBoxCoarsener (const Array<Interpolater*>& mappers, const IntVect& ratio)
+                : m_mappers(mappers), m_ratio(ratio) { ; }
+            virtual Box doit (const Box& fine) const override
+            {
+                Box crse = m_mappers[0]->CoarseBox(fine, m_ratio);
+                for (int i = 1; i < m_mappers.size(); ++i) {
+                    crse = amrex::minBox(crse, m_mappers[i]->CoarseBox(fine, m_ratio));
+                }
+                return crse;
+            }
+            virtual BoxConverter* clone () const override
+            {
+                return new UnionBoxCoarsener(*this);
+            }
+        private:
+            Array<Interpolater*> m_mappers;
+            IntVect m_ratio;
+        };
+
+        Array<Interpolater*> SortedMappers (const Array<Interpolater*>& mappers)
+        {
+            Array<Interpolater*> r(mappers);
+            std::sort(r.begin(), r.end());
+            r.erase(std::unique(r.begin(), r.end()), r.end());
+            return r;
+        }
+    }
+
+    FillPatchPlan::FillPatchPlan (const MultiFab& mf, const MultiFab& fmf,
+                                  const Geometry& cgeom, const Geometry& fgeom,
+                                  const IntVect& ratio, const Array<Interpolater*>& mappers)
+        : m_dst_ba(mf.boxArray()),
+          m_src_ba(fmf.boxArray()),
+          m_dst_dm(mf.DistributionMap()),
+          m_src_dm(fmf.DistributionMap()),
+          m_ngrow(mf.nGrow()),
+          m_cgeom(cgeom),
+          m_fgeom(fgeom),
+          m_ratio(ratio),
+          m_mappers(SortedMappers(mappers))
+    {
+	BL_PROFILE("FillPatchPlan::FillPatchPlan()");
+
+        BL_ASSERT(!m_mappers.empty());
+
+	if (m_ngrow > 0 || mf.getBDKey() != fmf.getBDKey())
+	{
+	    Box fdomain = fgeom.Domain();
+	    fdomain.convert(mf.boxArray().ixType());
+	    Box fdomain_g(fdomain);
+	    for (int i = 0; i < BL_SPACEDIM; ++i) {
+		if (fgeom.isPeriodic(i)) {
+		    fdomain_g.grow(i,m_ngrow);
+		}
+	    }
+
+            const Box& cdomain = amrex::coarsen(fgeom.Domain(),ratio);
+
+            const FabArrayBase::FPinfo& fpc = (m_mappers.size() == 1)
+                ? FabArrayBase::TheFPinfo(fmf, mf, fdomain_g, m_ngrow,
+                                          m_mappers[0]->BoxCoarsener(ratio), cdomain)
+                : FabArrayBase::TheFPinfo(fmf, mf, fdomain_g, m_ngrow,
+                                          UnionBoxCoarsener(m_mappers,ratio), cdomain);
+
+            if ( ! fpc.ba_crse_patch.empty())
+            {
+                m_ba_crse_patch = fpc.ba_crse_patch;
+                m_dm_crse_patch = fpc.dm_crse_patch;
+                m_dst_idxs      = fpc.dst_idxs;
+                m_dst_boxes     = fpc.dst_boxes;
+                m_fact_crse_patch.reset(fpc.fact_crse_patch->clone());
+            }
+	}
+    }
+
+    bool
+    FillPatchPlan::isValidFor (const MultiFab& mf, const MultiFab& fmf, const IntVect& ratio,
+                               const Array<Interpolater*>& mappers) const
+    {
+        return mf.getBDKey()  == FabArrayBase::BDKey(m_dst_ba.getRefID(), m_dst_dm.getRefID())
+            && fmf.getBDKey() == FabArrayBase::BDKey(m_src_ba.getRefID(), m_src_dm.getRefID())
+            && mf.boxArray().ixType() == m_dst_ba.ixType()
+            && mf.nGrow()     == m_ngrow
+            && ratio          == m_ratio
+            && SortedMappers(mappers) == m_mappers;
+    }
+
+    void
+    FillPatchPlan::add (MultiFab& mf,
+                        const Array<MultiFab*>& cmf, const Array<Real>& ct,
+                        const Array<MultiFab*>& fmf, const Array<Real>& ft,
+                        int scomp, int dcomp, int ncomp,
+                        PhysBCFunctBase& cbc, PhysBCFunctBase& fbc,
+                        Interpolater* mapper, const Array<BCRec>& bcs)
+    {
+        BL_ASSERT(isValidFor(mf, *fmf[0], m_ratio, m_mappers));
+        BL_ASSERT(std::find(m_mappers.begin(), m_mappers.end(), mapper) != m_mappers.end());
+	BL_ASSERT(dcomp+ncomp <= mf.nComp());
+
+        Range r;
+        r.mf     = &mf;
+        r.cmf    = cmf;
+        r.ct     = ct;
+        r.fmf    = fmf;
+        r.ft     = ft;
+        r.scomp  = scomp;
+        r.dcomp  = dcomp;
+        r.ncomp  = ncomp;
+        r.cbc    = &cbc;
+        r.fbc    = &fbc;
+        r.mapper = mapper;
+        r.bcs    = bcs;
+        m_ranges.push_back(r);
+    }
+
+    void
+    FillPatchPlan::fill (Real time)
+    {
+	BL_PROFILE("FillPatchPlan::fill()");
+
+        if ( ! m_ba_crse_patch.empty() && ! m_ranges.empty())
+        {
+            //
+            // The ranges are stacked in the components of one coarse patch.
+            //
+            Array<int> crse_comp(m_ranges.size());
+            int ncomp = 0;
+            for (int i = 0; i < m_ranges.size(); ++i) {
+                crse_comp[i] = ncomp;
+                ncomp += m_ranges[i].ncomp;
+            }
+
+            if (m_crse_patch.empty() || m_crse_patch.nComp() < ncomp) {
+                m_crse_patch.clear();
+                m_crse_patch.define(m_ba_crse_patch, m_dm_crse_patch, ncomp, 0, MFInfo(),
+                                    *m_fact_crse_patch);
+            }
+
+            for (int i = 0; i < m_ranges.size(); ++i)
+            {
+                Range& r = m_ranges[i];
+                FillPatchSingleLevel(m_crse_patch, time, r.cmf, r.ct, r.scomp, crse_comp[i], r.ncomp,
+                                     m_cgeom, *r.cbc);
+            }
+
+            Box fdomain = m_fgeom.Domain();
+            fdomain.convert(m_dst_ba.ixType());
+
+	    int idummy1=0, idummy2=0;
+	    bool cc = m_ba_crse_patch.ixType().cellCentered();
+            ignore_unused(cc);
+#ifdef _OPENMP
+#pragma omp parallel if (cc)
+#endif
+            for (MFIter mfi(m_crse_patch); mfi.isValid(); ++mfi)
+            {
+                int li = mfi.LocalIndex();
+                int gi = m_dst_idxs[li];
+                const Box& dbx = m_dst_boxes[li];
+
+                for (int i = 0; i < m_ranges.size(); ++i)
+                {
+                    Range& r = m_ranges[i];
+
+                    Array<BCRec> bcr(r.ncomp);
+                    amrex::setBC(dbx,fdomain,r.scomp,0,r.ncomp,r.bcs,bcr);
+
+                    r.mapper->interp(m_crse_patch[mfi],
+                                     crse_comp[i],
+                                     (*r.mf)[gi],
+                                     r.dcomp,
+                                     r.ncomp,
+                                     dbx,
+                                     m_ratio,
+                                     m_cgeom,
+                                     m_fgeom,
+                                     bcr,
+                                     idummy1, idummy2);
+                }
+            }
+        }
+
+        for (int i = 0; i < m_ranges.size(); ++i)
+        {
+            Range& r = m_ranges[i];
+            FillPatchSingleLevel(*r.mf, time, r.fmf, r.ft, r.scomp, r.dcomp, r.ncomp,
+                                 m_fgeom, *r.fbc);
+        }
+
+        m_ranges.clear();
+    }
+
     void InterpFromCoarseLevel (MultiFab& mf, Real time, const MultiFab& cmf, 
 				int scomp, int dcomp, int ncomp,
 				const Geometry& cgeom, const Geometry& fgeom, 
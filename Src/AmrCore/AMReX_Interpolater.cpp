@@ -1,10 +1,14 @@
 
 #include <climits>
+#include <atomic>
 
+#include <AMReX.H>
 #include <AMReX_FArrayBox.H>
 #include <AMReX_Geometry.H>
 #include <AMReX_Interpolater.H>
+#include <AMReX_InterpKernels.H>
 #include <AMReX_INTERP_F.H>
+#include <AMReX_ParmParse.H>
 
 namespace amrex {
 
@@ -27,6 +31,54 @@ CellConservativeQuartic   quartic_interp;
 
 Interpolater::~Interpolater () {}
 
+namespace
+{
+    bool initialized = false;
+    //
+    // Set from interp.native_kernels by Initialize, outside any parallel
+    // region, and by SetNativeKernels.  Only read by the kernels.
+    //
+    std::atomic<int> use_native_kernels(0);
+    //
+    // The row buffers of the C++ kernels, kept by each thread.
+    //
+    thread_local Array<Real> interp_work;
+}
+
+void
+Interpolater::Initialize ()
+{
+    if (initialized) return;
+    initialized = true;
+
+    int use = 0;
+    ParmParse pp("interp");
+    pp.query("native_kernels", use);
+    use_native_kernels.store(use, std::memory_order_relaxed);
+
+    amrex::ExecOnFinalize(Interpolater::Finalize);
+}
+
+void
+Interpolater::Finalize ()
+{
+    initialized = false;
+    use_native_kernels.store(0, std::memory_order_relaxed);
+}
+
+bool
+Interpolater::NativeKernels ()
+{
+    return use_native_kernels.load(std::memory_order_relaxed) != 0;
+}
+
+void
+Interpolater::SetNativeKernels (bool use)
+{
+    Initialize();
+    use_native_kernels.store(use, std::memory_order_relaxed);
+}
+
 InterpolaterBoxCoarsener
 Interpolater::BoxCoarsener (const IntVect& ratio)
 { 
@@ -275,6 +327,22 @@ CellConservativeLinear::interp (const FArrayBox& crse,
     // Make box which is intersection of fine_region and domain of fine.
     //
     Box target_fine_region = fine_region & fine.box();
+
+    if (NativeKernels() && crse_geom.IsCartesian())
+    {
+        if (ratio == 2)
+        {
+            LinCCInterpKernel<2>(crse, crse_comp, fine, fine_comp, ncomp,
+                                 target_fine_region, bcr, do_linear_limiting, interp_work);
+            return;
+        }
+        if (ratio == 4)
+        {
+            LinCCInterpKernel<4>(crse, crse_comp, fine, fine_comp, ncomp,
+                                 target_fine_region, bcr, do_linear_limiting, interp_work);
+            return;
+        }
+    }
     //
     // crse_bx is coarsening of target_fine_region, grown by 1.
     //
@@ -543,6 +611,20 @@ PCInterp::interp (const FArrayBox& crse,
                   int               actual_state)
 {
     BL_PROFILE("PCInterp::interp()");
+
+    if (NativeKernels())
+    {
+        if (ratio == 2)
+        {
+            PCInterpKernel<2>(crse, crse_comp, fine, fine_comp, ncomp, fine_region);
+            return;
+        }
+        if (ratio == 4)
+        {
+            PCInterpKernel<4>(crse, crse_comp, fine, fine_comp, ncomp, fine_region);
+            return;
+        }
+    }
     //
     // Set up to call FORTRAN.
     //
@@ -416,6 +416,299 @@ TagBox::tags_and_untags (const Array<int>& ar, const Box& tilebx)
     }
 }
 
+namespace {
+    typedef TagBitMask::Word Word;
+    const int WordBits = 8*sizeof(Word);
+}
+
+//
+// First cell in [pos,end) of a row whose bit is val, or end.
+//
+
+static
+int
+FindBit (const Word* row, int pos, int end, bool val)
+{
+    while (pos < end)
+    {
+        Word w = row[pos/WordBits];
+        if (!val) w = ~w;
+        w >>= pos%WordBits;
+        if (w == 0)
+        {
+            pos = (pos/WordBits + 1)*WordBits;
+            continue;
+        }
+        while (!(w & 1))
+        {
+            w >>= 1;
+            ++pos;
+        }
+        return std::min(pos,end);
+    }
+    return end;
+}
+
+//
+// Set the bits of cells [pos,end) of a row.
+//
+
+static
+void
+SetBits (Word* row, int pos, int end)
+{
+    for ( ; pos < end && pos%WordBits != 0; ++pos)
+        row[pos/WordBits] |= Word(1) << (pos%WordBits);
+    for ( ; pos+WordBits <= end; pos += WordBits)
+        row[pos/WordBits] = ~Word(0);
+    for ( ; pos < end; ++pos)
+        row[pos/WordBits] |= Word(1) << (pos%WordBits);
+}
+
+//
+// Loop over the rows of Box b, with j and k the row's indices.
+//
+#define TAGBITMASK_ROW_LOOP(b)                                          \
+    int klo = 0, khi = 0, jlo = 0, jhi = 0;                             \
+    AMREX_D_TERM( ,                                                     \
+                  jlo = (b).smallEnd(1); jhi = (b).bigEnd(1); ,         \
+                  klo = (b).smallEnd(2); khi = (b).bigEnd(2); )         \
+    for (int k = klo; k <= khi; k++)                                    \
+        for (int j = jlo; j <= jhi; j++)
+
+TagBitMask::TagBitMask ()
+    :
+    m_nwords(0)
+{}
+
+TagBitMask::TagBitMask (const Box& bx)
+{
+    define(bx);
+}
+
+void
+TagBitMask::define (const Box& bx)
+{
+    m_box = bx;
+
+    if (bx.ok())
+    {
+        m_nwords = (bx.length(0) + WordBits - 1)/WordBits;
+        Array<Word>(m_nwords*(bx.numPts()/bx.length(0)), 0).swap(m_bits);
+    }
+    else
+    {
+        m_nwords = 0;
+        Array<Word>().swap(m_bits);
+    }
+}
+
+long
+TagBitMask::rowIndex (const IntVect& iv) const
+{
+    return AMREX_D_TERM(0,
+                        + (iv[1]-m_box.smallEnd(1)),
+                        + long(iv[2]-m_box.smallEnd(2))*m_box.length(1));
+}
+
+bool
+TagBitMask::test (const IntVect& iv) const
+{
+    BL_ASSERT(m_box.contains(iv));
+    const int i = iv[0] - m_box.smallEnd(0);
+    return (row(rowIndex(iv))[i/WordBits] >> (i%WordBits)) & 1;
+}
+
+void
+TagBitMask::set (const IntVect& iv)
+{
+    BL_ASSERT(m_box.contains(iv));
+    const int i = iv[0] - m_box.smallEnd(0);
+    row(rowIndex(iv))[i/WordBits] |= Word(1) << (i%WordBits);
+}
+
+long
+TagBitMask::numTags () const
+{
+    return numTags(m_box);
+}
+
+long
+TagBitMask::numTags (const Box& bx) const
+{
+    const Box& b = bx & m_box;
+
+    if (!b.ok()) return 0L;
+
+    const int a = b.smallEnd(0) - m_box.smallEnd(0);
+    const int e = b.bigEnd(0)   - m_box.smallEnd(0) + 1;
+
+    long nt = 0L;
+    TAGBITMASK_ROW_LOOP(b)
+    {
+        const Word* r = row(rowIndex(IntVect(AMREX_D_DECL(b.smallEnd(0),j,k))));
+        for (int i = FindBit(r,a,e,true); i < e; )
+        {
+            const int ie = FindBit(r,i,e,false);
+            nt += ie - i;
+            i = FindBit(r,ie,e,true);
+        }
+    }
+    return nt;
+}
+
+Box
+TagBitMask::minBox (const Box& bx) const
+{
+    const Box& b = bx & m_box;
+
+    if (!b.ok()) return Box();
+
+    const int ilo = m_box.smallEnd(0);
+    const int a   = b.smallEnd(0) - ilo;
+    const int e   = b.bigEnd(0)   - ilo + 1;
+
+    bool    found = false;
+    IntVect lo, hi;
+    TAGBITMASK_ROW_LOOP(b)
+    {
+        const Word* r = row(rowIndex(IntVect(AMREX_D_DECL(b.smallEnd(0),j,k))));
+        const int first = FindBit(r,a,e,true);
+        if (first == e) continue;
+        int last = first;
+        for (int i = first; i < e; )
+        {
+            const int ie = FindBit(r,i,e,false);
+            last = ie - 1;
+            i = FindBit(r,ie,e,true);
+        }
+        const IntVect ivlo(AMREX_D_DECL(ilo+first,j,k));
+        const IntVect ivhi(AMREX_D_DECL(ilo+last,j,k));
+        if (found)
+        {
+            lo.min(ivlo);
+            hi.max(ivhi);
+        }
+        else
+        {
+            lo = ivlo;
+            hi = ivhi;
+            found = true;
+        }
+    }
+    return found ? Box(lo,hi) : Box();
+}
+
+void
+TagBitMask::signature (const Box& bx, Array<int>* hist) const
+{
+    BL_ASSERT(m_box.contains(bx));
+
+    for (int n = 0; n < BL_SPACEDIM; n++)
+        hist[n].assign(bx.length(n), 0);
+
+    const int a = bx.smallEnd(0) - m_box.smallEnd(0);
+    const int e = bx.bigEnd(0)   - m_box.smallEnd(0) + 1;
+
+    TAGBITMASK_ROW_LOOP(bx)
+    {
+        const Word* r = row(rowIndex(IntVect(AMREX_D_DECL(bx.smallEnd(0),j,k))));
+        int cnt = 0;
+        for (int i = FindBit(r,a,e,true); i < e; )
+        {
+            const int ie = FindBit(r,i,e,false);
+            for (int ii = i; ii < ie; ii++)
+                hist[0][ii-a]++;
+            cnt += ie - i;
+            i = FindBit(r,ie,e,true);
+        }
+        AMREX_D_TERM( ,
+                      hist[1][j-jlo] += cnt; ,
+                      hist[2][k-klo] += cnt; )
+    }
+}
+
+void
+TagBitMask::merge (const TagBox& src)
+{
+    BL_ASSERT(src.nComp() == 1);
+
+    const Box& b = m_box & src.box();
+
+    if (!b.ok()) return;
+
+    const int a   = b.smallEnd(0) - m_box.smallEnd(0);
+    const int len = b.length(0);
+
+    TAGBITMASK_ROW_LOOP(b)
+    {
+        const IntVect iv(AMREX_D_DECL(b.smallEnd(0),j,k));
+        const TagBox::TagType* d = src.dataPtr() + src.box().index(iv);
+        Word* r = row(rowIndex(iv));
+        for (int i = 0; i < len; i++)
+        {
+            if (d[i] != TagBox::CLEAR)
+                r[(a+i)/WordBits] |= Word(1) << ((a+i)%WordBits);
+        }
+    }
+}
+
+void
+TagBitMask::encode (Array<long>& runs) const
+{
+    runs.clear();
+
+    if (!m_box.ok()) return;
+
+    const int  nx    = m_box.length(0);
+    const long nrows = m_bits.size()/m_nwords;
+
+    for (long r = 0; r < nrows; r++)
+    {
+        const Word* rw = row(r);
+        for (int i = FindBit(rw,0,nx,true); i < nx; )
+        {
+            const int  ie    = FindBit(rw,i,nx,false);
+            const long start = r*nx + i;
+            const int  n     = runs.size();
+            if (n > 0 && runs[n-2]+runs[n-1] == start)
+            {
+                runs[n-1] += ie - i;
+            }
+            else
+            {
+                runs.push_back(start);
+                runs.push_back(ie - i);
+            }
+            i = FindBit(rw,ie,nx,true);
+        }
+    }
+}
+
+void
+TagBitMask::decode (const long* runs, long nruns)
+{
+    const long nx = m_box.length(0);
+
+    for (long n = 0; n < nruns; n++)
+    {
+        long start = runs[2*n];
+        long len   = runs[2*n+1];
+        BL_ASSERT(start >= 0 && start+len <= m_box.numPts());
+        while (len > 0)
+        {
+            const long r   = start/nx;
+            const long i   = start%nx;
+            const long end = std::min(nx, i+len);
+            SetBits(row(r), i, end);
+            len   -= end - i;
+            start += end - i;
+        }
+    }
+}
+
+#undef TAGBITMASK_ROW_LOOP
+
 TagBoxArray::TagBoxArray (const BoxArray& ba,
 			  const DistributionMapping& dm,
                           int             _ngrow)
@@ -491,9 +784,9 @@ TagBoxArray::numTags () const
 }
 
 void
-TagBoxArray::collate (std::vector<IntVect>& TheGlobalCollateSpace) const
+TagBoxArray::collateLocal (std::vector<IntVect>& TheLocalCollateSpace) const
 {
-    BL_PROFILE("TagBoxArray::collate()");
+    BL_PROFILE("TagBoxArray::collateLocal()");
 
     long count = 0;
 
@@ -505,10 +798,7 @@ TagBoxArray::collate (std::vector<IntVect>& TheGlobalCollateSpace) const
         count += get(fai).numTags();
     }
 
-    //
-    // Local space for holding just those tags we want to gather to the root cpu.
-    //
-    std::vector<IntVect> TheLocalCollateSpace(count);
+    TheLocalCollateSpace.resize(count);
 
     count = 0;
 
@@ -526,8 +816,22 @@ TagBoxArray::collate (std::vector<IntVect>& TheGlobalCollateSpace) const
 	std::set<IntVect> tmp (TheLocalCollateSpace.begin(),
 			       TheLocalCollateSpace.end());
 	TheLocalCollateSpace.assign( tmp.begin(), tmp.end() );
-	count = TheLocalCollateSpace.size();
     }
+}
+
+void
+TagBoxArray::collate (std::vector<IntVect>& TheGlobalCollateSpace) const
+{
+    BL_PROFILE("TagBoxArray::collate()");
+
+    //
+    // Local space for holding just those tags we want to gather to the root cpu.
+    //
+    std::vector<IntVect> TheLocalCollateSpace;
+
+    collateLocal(TheLocalCollateSpace);
+
+    long count = TheLocalCollateSpace.size();
     //
     // The total number of tags system wide that must be collated.
     // This is really just an estimate of the upper bound due to duplicates.
@@ -549,7 +853,7 @@ TagBoxArray::collate (std::vector<IntVect>& TheGlobalCollateSpace) const
 
     TheGlobalCollateSpace.resize(numtags);
 
-#if BL_USE_MPI
+#ifdef BL_USE_MPI
     //
     // Tell root CPU how many tags each CPU will be sending.
     //
@@ -599,6 +903,88 @@ TagBoxArray::collate (std::vector<IntVect>& TheGlobalCollateSpace) const
 #endif
 }
 
+void
+TagBoxArray::collateLocal (TagBitMask& mask) const
+{
+    BL_PROFILE("TagBoxArray::collateLocal(TagBitMask)");
+
+    Box bx;
+    for (MFIter fai(*this); fai.isValid(); ++fai)
+    {
+        const Box& fbx = get(fai).box();
+        bx = bx.ok() ? amrex::minBox(bx,fbx) : fbx;
+    }
+
+    mask.define(bx);
+
+    // unsafe to do OMP
+    for (MFIter fai(*this); fai.isValid(); ++fai)
+    {
+        mask.merge(get(fai));
+    }
+}
+
+void
+TagBoxArray::collate (TagBitMask& mask) const
+{
+    BL_PROFILE("TagBoxArray::collate(TagBitMask)");
+
+    const Box& bx = amrex::grow(boxArray().minimalBox(), n_grow);
+
+    mask.define(bx);
+
+    // unsafe to do OMP
+    for (MFIter fai(*this); fai.isValid(); ++fai)
+    {
+        mask.merge(get(fai));
+    }
+
+#ifdef BL_USE_MPI
+    //
+    // Gather the runs of tags to the root CPU, which merges them and
+    // broadcasts the result.  The runs of a few compact clusters take
+    // far less room than either the mask or a list of IntVects.
+    //
+    Array<long> runs;
+    mask.encode(runs);
+
+    const int IOProcNumber = ParallelDescriptor::IOProcessorNumber();
+    long count = runs.size();
+    const std::vector<long>& countvec = ParallelDescriptor::Gather(count, IOProcNumber);
+
+    std::vector<long> offset(countvec.size(),0L);
+    Array<long> allruns;
+    if (ParallelDescriptor::IOProcessor())
+    {
+        for (int i = 1, N = offset.size(); i < N; i++) {
+            offset[i] = offset[i-1] + countvec[i-1];
+        }
+        allruns.resize(offset.back() + countvec.back());
+    }
+    ParallelDescriptor::Gatherv(runs.dataPtr(), count,
+                                allruns.dataPtr(), countvec, offset, IOProcNumber);
+
+    mask.define(bx);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        mask.decode(allruns.dataPtr(), allruns.size()/2);
+        Array<long>().swap(allruns);
+        mask.encode(runs);
+        count = runs.size();
+    }
+
+    ParallelDescriptor::Bcast(&count, 1, IOProcNumber);
+    runs.resize(count);
+    ParallelDescriptor::Bcast(runs.dataPtr(), count, IOProcNumber);
+
+    if (!ParallelDescriptor::IOProcessor())
+    {
+        mask.decode(runs.dataPtr(), count/2);
+    }
+#endif
+}
+
 void
 TagBoxArray::setVal (const BoxList& bl,
                      TagBox::TagVal val)
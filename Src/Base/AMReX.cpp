@@ -379,6 +379,7 @@ amrex::Initialize (int& argc, char**& argv, bool build_parm_parse,
     amrex_mempool_init();
 
     // For thread safety, we should do these initializations here.
+    BaseFab_Initialize();
     BoxArray::Initialize();
     DistributionMapping::Initialize();
     FArrayBox::Initialize();
@@ -2,10 +2,14 @@
 
 #include <cstring>
 #include <cstdlib>
+#include <unistd.h>
 
+#include <AMReX.H>
 #include <AMReX_BaseFab.H>
 #include <AMReX_BArena.H>
 #include <AMReX_CArena.H>
+#include <AMReX_TArena.H>
+#include <AMReX_ParmParse.H>
 
 #if !defined(BL_NO_FORT)
 #include <AMReX_BaseFab_f.H>
@@ -67,6 +71,51 @@ BF_init::~BF_init ()
         delete the_arena;
 }
 
+void
+BaseFab_Initialize ()
+{
+    ParmParse pp("amrex");
+
+    std::string arena_name;
+    if (pp.query("fab_arena", arena_name))
+    {
+        Arena* arena = nullptr;
+        if (arena_name == "BArena") {
+            arena = new BArena;
+        } else if (arena_name == "CArena") {
+#ifdef _OPENMP
+            // Fabs are allocated inside parallel regions, and CArena has no lock.
+            amrex::Abort("BaseFab_Initialize: amrex.fab_arena=CArena is not thread safe; use TArena with OpenMP");
+#endif
+            arena = new CArena;
+        } else if (arena_name == "TArena") {
+            arena = new TArena;
+        } else {
+            amrex::Abort("BaseFab_Initialize: unknown amrex.fab_arena " + arena_name);
+        }
+
+        if (amrex::TotalBytesAllocatedInFabs() != 0) {
+            amrex::Abort("BaseFab_Initialize: fabs allocated before amrex::Initialize");
+        }
+
+        delete the_arena;
+        the_arena = arena;
+    }
+
+    amrex::ExecOnFinalize(BaseFab_Finalize);
+}
+
+void
+BaseFab_Finalize ()
+{
+    if (amrex::system::verbose)
+    {
+        if (const TArena* tarena = dynamic_cast<const TArena*>(the_arena)) {
+            tarena->PrintStats();
+        }
+    }
+}
+
 long 
 TotalBytesAllocatedInFabs()
 {
@@ -155,6 +204,16 @@ update_fab_stats (long n, long s, size_t szt)
     }
 }
 
+long
+fab_page_size ()
+{
+    static const long pagesize = [] () {
+        long ps = ::sysconf(_SC_PAGESIZE);
+        return (ps > 0) ? ps : 4096L;
+    }();
+    return pagesize;
+}
+
 Arena*
 The_Arena ()
 {
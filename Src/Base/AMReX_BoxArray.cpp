@@ -1,4 +1,8 @@
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include <AMReX_BLassert.H>
 #include <AMReX_BoxArray.H>
 #include <AMReX_ParallelDescriptor.H>
@@ -17,8 +21,8 @@ int  BARef::numboxarrays         = 0;
 int  BARef::numboxarrays_hwm     = 0;
 long BARef::total_box_bytes      = 0L;
 long BARef::total_box_bytes_hwm  = 0L;
-long BARef::total_hash_bytes     = 0L;
-long BARef::total_hash_bytes_hwm = 0L;
+long BARef::total_index_bytes     = 0L;
+long BARef::total_index_bytes_hwm = 0L;
 #endif
 
 bool    BARef::initialized = false;
@@ -26,6 +30,76 @@ bool BoxArray::initialized = false;
 
 namespace {
     const int bl_ignore_max = 100000;
+    //
+    // The maximum number of boxes in a leaf of the spatial index.
+    //
+    const int BVHLeafSize = 8;
+
+    void buildBVHNode (const BARef& ref, int n, int begin, int end)
+    {
+        Box bbox = ref.m_abox[ref.bvh_order[begin]];
+        for (int k = begin+1; k < end; ++k) {
+            bbox.minBox(ref.m_abox[ref.bvh_order[k]]);
+        }
+        ref.bvh_nodes[n].bbox  = bbox;
+        ref.bvh_nodes[n].begin = begin;
+        ref.bvh_nodes[n].end   = end;
+
+        if (end - begin <= BVHLeafSize) {
+            ref.bvh_nodes[n].left = -1;
+        } else {
+            const int left = ref.bvh_nodes.size();
+            ref.bvh_nodes.resize(left+2);
+            ref.bvh_nodes[n].left = left;
+            const int mid = (begin + end) / 2;
+            buildBVHNode(ref, left,   begin, mid);
+            buildBVHNode(ref, left+1, mid,   end);
+        }
+    }
+
+    //
+    // Box::intersects without the IndexType checks; all the boxes here
+    // are cell-centered.
+    //
+    inline bool overlaps (const Box& a, const Box& b)
+    {
+        return a.smallEnd().allLE(b.bigEnd()) && b.smallEnd().allLE(a.bigEnd());
+    }
+
+    //
+    // Call f(i) for the boxes i whose stored boxes intersect the
+    // cell-centered box q, until f returns true.
+    //
+    template <class F>
+    void forEachCandidate (const BARef& ref, const Box& q, F&& f)
+    {
+        if (!ref.bvh_nodes.empty() && overlaps(ref.bvh_nodes[0].bbox, q))
+        {
+            int stack[64];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const BARef::BVHNode& node = ref.bvh_nodes[stack[--top]];
+                if (node.left < 0)
+                {
+                    for (int k = node.begin; k < node.end; ++k) {
+                        const int i = ref.bvh_order[k];
+                        if (overlaps(ref.m_abox[i], q) && f(i)) return;
+                    }
+                }
+                else
+                {
+                    if (overlaps(ref.bvh_nodes[node.left+1].bbox, q)) stack[top++] = node.left+1;
+                    if (overlaps(ref.bvh_nodes[node.left  ].bbox, q)) stack[top++] = node.left;
+                }
+            }
+        }
+
+        for (const int i : ref.bvh_extra) {
+            if (overlaps(ref.m_abox[i], q) && f(i)) return;
+        }
+    }
 }
 
 BARef::BARef () 
@@ -70,7 +144,7 @@ BARef::BARef (std::istream& is)
 }
 
 BARef::BARef (const BARef& rhs) 
-    : m_abox(rhs.m_abox) // don't copy hash
+    : m_abox(rhs.m_abox) // don't copy the index
 {
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(1);
@@ -81,7 +155,7 @@ BARef::~BARef ()
 {
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(-1);
-    updateMemoryUsage_hash(-1);
+    updateMemoryUsage_index(-1);
 #endif	    
 }
 
@@ -142,13 +216,11 @@ BARef::define (BoxList&& bl) noexcept
 
 void 
 BARef::resize (long n) {
+    clearIndex();
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(-1);
-    updateMemoryUsage_hash(-1);
 #endif
     m_abox.resize(n);
-    hash.clear();
-    has_hashmap = false;
 #ifdef BL_MEM_PROFILING
     updateMemoryUsage_box(1);
 #endif
@@ -173,24 +245,119 @@ BARef::updateMemoryUsage_box (int s)
 }
 
 void
-BARef::updateMemoryUsage_hash (int s)
+BARef::updateMemoryUsage_index (int s) const
 {
-    if (hash.size() > 0) {
-	long b = sizeof(hash);
-	for (const auto& x: hash) {
-	    b += amrex::gcc_map_node_extra_bytes
-		+ sizeof(IntVect) + amrex::bytesOf(x.second);
-	}
+    if (has_index) {
+	long b = amrex::bytesOf(bvh_nodes) + amrex::bytesOf(bvh_order)
+	    + amrex::bytesOf(bvh_extra);
 	if (s > 0) {
-	    total_hash_bytes += b;
-	    total_hash_bytes_hwm = std::max(total_hash_bytes_hwm, total_hash_bytes);
+	    total_index_bytes += b;
+	    total_index_bytes_hwm = std::max(total_index_bytes_hwm, total_index_bytes);
 	} else {
-	    total_hash_bytes -= b;
+	    total_index_bytes -= b;
 	}
     }
 }
 #endif
 
+void
+BARef::buildIndex () const
+{
+    clearIndex();
+
+    const int N = m_abox.size();
+    Box bbox;
+    for (int i = 0; i < N; ++i)
+    {
+        if (m_abox[i].ok())   // ---- an empty box intersects nothing
+        {
+            if (bvh_order.empty()) {
+                bbox = m_abox[i];
+            } else {
+                bbox.minBox(m_abox[i]);
+            }
+            bvh_order.push_back(i);
+        }
+    }
+
+    const int n = bvh_order.size();
+    if (n > 0)
+    {
+        //
+        // Sort the boxes along a Morton curve through their centers, so
+        // that the boxes in a node of the tree are close together.
+        //
+        const int nbits = 63 / BL_SPACEDIM;
+        const double scale = static_cast<double>((std::uint64_t(1) << nbits) - 1);
+        std::vector< std::pair<std::uint64_t,int> > keys(n);
+        for (int k = 0; k < n; ++k)
+        {
+            const Box& b = m_abox[bvh_order[k]];
+            std::uint64_t c[BL_SPACEDIM];
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                const double x = (0.5*(b.smallEnd(d) + b.bigEnd(d)) - bbox.smallEnd(d)) / bbox.length(d);
+                c[d] = static_cast<std::uint64_t>(x * scale);
+            }
+            std::uint64_t code = 0;
+            for (int bit = nbits-1; bit >= 0; --bit) {
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    code = (code << 1) | ((c[d] >> bit) & 1);
+                }
+            }
+            keys[k] = std::make_pair(code, bvh_order[k]);
+        }
+        std::sort(keys.begin(), keys.end());
+        for (int k = 0; k < n; ++k) {
+            bvh_order[k] = keys[k].second;
+        }
+
+        bvh_nodes.reserve(2*(n/BVHLeafSize) + 2);
+        bvh_nodes.resize(1);
+        buildBVHNode(*this, 0, 0, n);
+    }
+
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+    has_index = true;
+
+#ifdef BL_MEM_PROFILING
+    updateMemoryUsage_index(1);
+#endif
+}
+
+void
+BARef::clearIndex () const
+{
+#ifdef BL_MEM_PROFILING
+    updateMemoryUsage_index(-1);
+#endif
+    Array<BVHNode>().swap(bvh_nodes);
+    Array<int>().swap(bvh_order);
+    Array<int>().swap(bvh_extra);
+    has_index = false;
+}
+
+void
+BARef::addToIndex (int i)
+{
+    if (!has_index) return;   // ---- it will be in the index when that is built
+
+#ifdef BL_MEM_PROFILING
+    updateMemoryUsage_index(-1);
+#endif
+    bvh_extra.push_back(i);
+#ifdef BL_MEM_PROFILING
+    updateMemoryUsage_index(1);
+#endif
+    //
+    // The extra boxes are searched one by one, so rebuild once there are many.
+    //
+    if (bvh_extra.size() > 64 && 4*bvh_extra.size() > bvh_order.size()) {
+        buildIndex();
+    }
+}
+
 void
 BARef::Initialize ()
 {
@@ -201,9 +368,9 @@ BARef::Initialize ()
 			 ([] () -> MemProfiler::MemInfo {
 			     return {total_box_bytes, total_box_bytes_hwm};
 			 }));
-	MemProfiler::add("BoxArrayHash", std::function<MemProfiler::MemInfo()>
+	MemProfiler::add("BoxArrayIndex", std::function<MemProfiler::MemInfo()>
 			 ([] () -> MemProfiler::MemInfo {
-			     return {total_hash_bytes, total_hash_bytes_hwm};
+			     return {total_index_bytes, total_index_bytes_hwm};
 			 }));
 	MemProfiler::add("BoxArray Innard", std::function<MemProfiler::NBuildsInfo()>
 			 ([] () -> MemProfiler::NBuildsInfo {
@@ -903,52 +1070,36 @@ BoxArray::intersections (const Box&                         bx,
 {
   // This is called too many times BL_PROFILE("BoxArray::intersections()");
 
-    BARef::HashType& BoxHashMap = getHashMap();
+    const BARef& ref = getIndex();
 
     isects.resize(0);
 
-    if (!BoxHashMap.empty())
+    if (!empty())
     {
         BL_ASSERT(bx.ixType() == ixType());
 
 	Box gbx = amrex::grow(bx,ng);
-
-	IntVect glo = gbx.smallEnd();
-	IntVect ghi = gbx.bigEnd();
+        //
+        // The cell-centered box, in the space of the stored boxes, that
+        // the stored box of every intersecting box intersects.
+        //
 	const IntVect& doilo = getDoiLo();
 	const IntVect& doihi = getDoiHi();
 
-	gbx.setSmall(glo - doihi).setBig(ghi + doilo);
-        gbx.refine(m_crse_ratio).coarsen(m_ref->crsn);
-	
-        const IntVect& sm = amrex::max(gbx.smallEnd()-1, m_ref->bbox.smallEnd());
-        const IntVect& bg = amrex::min(gbx.bigEnd(),     m_ref->bbox.bigEnd());
+        Box cbx(gbx.smallEnd() - doihi, gbx.bigEnd() + doilo);
+        cbx.refine(m_crse_ratio);
 
-        Box cbx(sm,bg);
-        cbx.normalize();
-
-	if (!cbx.intersects(m_ref->bbox)) return;
-
-	auto TheEnd = BoxHashMap.cend();
-
-        for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); iv <= End; cbx.next(iv))
+        forEachCandidate(ref, cbx, [&] (int index) -> bool
         {
-            auto it = BoxHashMap.find(iv);
+            const Box& isect = bx & amrex::grow((*this)[index],ng);
 
-            if (it != TheEnd)
+            if (isect.ok())
             {
-                for (const int index : it->second)
-                {
-                    const Box& isect = bx & amrex::grow((*this)[index],ng);
-
-                    if (isect.ok())
-                    {
-                        isects.push_back(std::pair<int,Box>(index,isect));
-			if (first_only) return;
-                    }
-                }
+                isects.push_back(std::pair<int,Box>(index,isect));
+                return first_only;
             }
-        }
+            return false;
+        });
     }
 }
 
@@ -959,56 +1110,33 @@ BoxArray::complementIn (const Box& bx) const
 
     if (!empty()) 
     {
-	BARef::HashType& BoxHashMap = getHashMap();
+	const BARef& ref = getIndex();
 
 	BL_ASSERT(bx.ixType() == ixType());
 
-	Box gbx = bx;
-
-	IntVect glo = gbx.smallEnd();
-	IntVect ghi = gbx.bigEnd();
 	const IntVect& doilo = getDoiLo();
 	const IntVect& doihi = getDoiHi();
 
-	gbx.setSmall(glo - doihi).setBig(ghi + doilo);
-        gbx.refine(m_crse_ratio).coarsen(m_ref->crsn);
-	
-        const IntVect& sm = amrex::max(gbx.smallEnd()-1, m_ref->bbox.smallEnd());
-        const IntVect& bg = amrex::min(gbx.bigEnd(),     m_ref->bbox.bigEnd());
-
-        Box cbx(sm,bg);
-        cbx.normalize();
-
-	if (!cbx.intersects(m_ref->bbox)) return bl;
-
-	auto TheEnd = BoxHashMap.cend();
+        Box cbx(bx.smallEnd() - doihi, bx.bigEnd() + doilo);
+        cbx.refine(m_crse_ratio);
 
         BoxList newbl(bl.ixType());
 
-	for (IntVect iv = cbx.smallEnd(), End = cbx.bigEnd(); 
-	     iv <= End && bl.isNotEmpty(); 
-	     cbx.next(iv))
+        forEachCandidate(ref, cbx, [&] (int index) -> bool
         {
-            auto it = BoxHashMap.find(iv);
+            const Box& isect = bx & (*this)[index];
 
-            if (it != TheEnd)
+            if (isect.ok())
             {
-                for (const int index : it->second)
-                {
-                    const Box& isect = bx & (*this)[index];
-
-                    if (isect.ok())
-                    {
-                        newbl.clear();
-                        for (const Box& b : bl) {
-                            const BoxList& diff = amrex::boxDiff(b, isect);
-                            newbl.join(diff);
-                        }
-                        std::swap(bl,newbl);
-                    }
+                newbl.clear();
+                for (const Box& b : bl) {
+                    const BoxList& diff = amrex::boxDiff(b, isect);
+                    newbl.join(diff);
                 }
+                std::swap(bl,newbl);
             }
-        }
+            return bl.isEmpty();
+        });
     }
 
     return bl;
@@ -1017,13 +1145,9 @@ BoxArray::complementIn (const Box& bx) const
 void
 BoxArray::clear_hash_bin () const
 {
-    if (!m_ref->hash.empty())
+    if (m_ref->has_index)
     {
-#ifdef BL_MEM_PROFILING
-	m_ref->updateMemoryUsage_hash(-1);
-#endif
-        m_ref->hash.clear();
-        m_ref->has_hashmap = false;
+        m_ref->clearIndex();
     }
 }
 
@@ -1043,8 +1167,6 @@ BoxArray::removeOverlap (bool simplify)
 
     uniqify();
 
-    BARef::HashType& BoxHashMap = m_ref->hash;
-
     const Box EmptyBox;
 
     std::vector< std::pair<int,Box> > isects;
@@ -1053,8 +1175,6 @@ BoxArray::removeOverlap (bool simplify)
     //
 #ifdef BL_MEM_PROFILING
     m_ref->updateMemoryUsage_box(-1);
-    m_ref->updateMemoryUsage_hash(-1);
-    long total_hash_bytes_save = m_ref->total_hash_bytes;
 #endif
     for (int i = 0; i < size(); i++)
     {
@@ -1075,7 +1195,7 @@ BoxArray::removeOverlap (bool simplify)
                 for (const Box& b : bl)
                 {
                     m_ref->m_abox.push_back(b);
-                    BoxHashMap[amrex::coarsen(b.smallEnd(),m_ref->crsn)].push_back(size()-1);
+                    m_ref->addToIndex(size()-1);
                 }
             }
         }
@@ -1101,10 +1221,6 @@ BoxArray::removeOverlap (bool simplify)
 
     *this = nba;
 
-#ifdef BL_MEM_PROFILING
-    m_ref->total_hash_bytes = total_hash_bytes_save;
-#endif
-
     BL_ASSERT(isDisjoint());
 }
 
@@ -1162,60 +1278,29 @@ BoxArray::getDoiHi () const
     return m_simple ?           m_typ.ixType() : m_transformer->doiHi();
 }
 
-BARef::HashType&
-BoxArray::getHashMap () const
+const BARef&
+BoxArray::getIndex () const
 {
-    BARef::HashType& BoxHashMap = m_ref->hash;
-
     bool local_flag;
     
 #ifdef _OPENMP
 #pragma omp atomic read
 #endif
-    local_flag = m_ref->has_hashmap;
-
-    if (local_flag) return BoxHashMap;
+    local_flag = m_ref->has_index;
 
+    if (!local_flag)
+    {
 #ifdef _OPENMP
-    #pragma omp critical(intersections_lock)
+#pragma omp critical(intersections_lock)
 #endif
-    {
-        if (BoxHashMap.empty() && size() > 0)
         {
-            //
-            // Calculate the bounding box & maximum extent of the boxes.
-            //
-	    IntVect maxext = IntVect::TheUnitVector();
-            Box boundingbox = m_ref->m_abox[0];
-
-	    const int N = size();
-	    for (int i = 0; i < N; ++i)
-            {
-                const Box& bx = m_ref->m_abox[i];
-                maxext = amrex::max(maxext, bx.size());
-                boundingbox.minBox(bx);
-            }
-
-            for (int i = 0; i < N; i++)
-            {
-                const IntVect& crsnsmlend 
-		    = amrex::coarsen(m_ref->m_abox[i].smallEnd(),maxext);
-                BoxHashMap[crsnsmlend].push_back(i);
+            if (!m_ref->has_index) {
+                m_ref->buildIndex();
             }
-
-            m_ref->crsn = maxext;
-            m_ref->bbox =boundingbox.coarsen(maxext);
-            m_ref->bbox.normalize();
-
-	    m_ref->has_hashmap = true;
-
-#ifdef BL_MEM_PROFILING
-	    m_ref->updateMemoryUsage_hash(1);
-#endif
         }
     }
 
-    return BoxHashMap;
+    return *m_ref;
 }
 
 void
@@ -19,6 +19,7 @@
 #include <map>
 #include <vector>
 #include <queue>
+#include <functional>
 #include <algorithm>
 #include <numeric>
 #include <string>
@@ -2592,26 +2593,36 @@ DistributionMapping::TranslateProcMap(const Array<int> &pm_old, const MPI_Group
 }
 #endif
 
+namespace {
+    Array<long>
+    scaled_cost (const Array<Real>& rcost)
+    {
+        Array<long> cost(rcost.size());
+
+        Real wmax = *std::max_element(rcost.begin(), rcost.end());
+        Real scale = (wmax > 0.0) ? 1.e9/wmax : 0.0;
+
+        for (int i = 0; i < rcost.size(); ++i) {
+            cost[i] = long(rcost[i]*scale) + 1L;
+        }
+
+        return cost;
+    }
+}
+
 DistributionMapping
-DistributionMapping::makeKnapSack (const Array<Real>& rcost)
+DistributionMapping::makeKnapSack (const Array<Real>& rcost, int nmax)
 {
     BL_PROFILE("makeKnapSack");
 
     DistributionMapping r;
 
-    Array<long> cost(rcost.size());
-
-    Real wmax = *std::max_element(rcost.begin(), rcost.end());
-    Real scale = 1.e9/wmax;
-
-    for (int i = 0; i < rcost.size(); ++i) {
-        cost[i] = long(rcost[i]*scale) + 1L;
-    }
+    Array<long> cost = scaled_cost(rcost);
 
     int nprocs = ParallelDescriptor::NProcs();
     Real eff;
 
-    r.KnapSackProcessorMap(cost, nprocs, &eff, true);
+    r.KnapSackProcessorMap(cost, nprocs, &eff, true, nmax);
 
     return r;
 }
@@ -2725,6 +2736,164 @@ DistributionMapping::makeSFC (const MultiFab& weight,
     return r;
 }
 
+DistributionMapping
+DistributionMapping::makeSFC (const Array<Real>& rcost,
+                              const BoxArray& boxes)
+{
+    BL_PROFILE("makeSFC");
+
+    DistributionMapping r;
+
+    Array<long> cost = scaled_cost(rcost);
+
+    int nprocs = ParallelDescriptor::NProcs();
+
+    r.SFCProcessorMap(boxes, cost, nprocs);
+
+    return r;
+}
+
+namespace {
+    //
+    // Greedy: take the (box, process, overlap) triples in order of decreasing
+    // overlap, and give the box to the process if neither has been taken
+    // care of and the process stays under the cap.  Then the boxes left,
+    // largest first, go to the least loaded processes.
+    //
+    Array<int>
+    remap_processor_map (const Array<long>&         wgts,
+                         const BoxArray&            boxes,
+                         const BoxArray&            old_boxes,
+                         const DistributionMapping& old_dm,
+                         Real                       tolerance,
+                         int                        nprocs)
+    {
+        const int N = boxes.size();
+
+        long total = 0, wmax = 0;
+        for (int i = 0; i < N; ++i) {
+            total += wgts[i];
+            wmax = std::max(wmax, wgts[i]);
+        }
+        const long cap = std::max(static_cast<long>(std::ceil((1.0+tolerance)*Real(total)/nprocs)), wmax);
+
+        struct Overlap {
+            long ncells;
+            int  box;
+            int  proc;
+        };
+        Array<Overlap> overlaps;
+
+        std::vector< std::pair<int,Box> > isects;
+        std::map<int,long> byproc;
+        for (int i = 0; i < N; ++i)
+        {
+            old_boxes.intersections(boxes[i], isects);
+            byproc.clear();
+            for (const auto& isec : isects) {
+                byproc[old_dm[isec.first]] += isec.second.numPts();
+            }
+            for (const auto& kv : byproc) {
+                overlaps.push_back(Overlap{kv.second, i, kv.first});
+            }
+        }
+
+        std::sort(overlaps.begin(), overlaps.end(),
+                  [] (const Overlap& a, const Overlap& b) {
+                      if (a.ncells != b.ncells) return a.ncells > b.ncells;
+                      if (a.box    != b.box)    return a.box    < b.box;
+                      return a.proc < b.proc;
+                  });
+
+        Array<int>  pmap(N, -1);
+        Array<long> load(nprocs, 0);
+
+        for (const auto& ov : overlaps)
+        {
+            if (pmap[ov.box] < 0 && load[ov.proc] + wgts[ov.box] <= cap) {
+                pmap[ov.box] = ov.proc;
+                load[ov.proc] += wgts[ov.box];
+            }
+        }
+
+        Array<int> rest;
+        for (int i = 0; i < N; ++i) {
+            if (pmap[i] < 0) rest.push_back(i);
+        }
+        std::stable_sort(rest.begin(), rest.end(),
+                         [&wgts] (int a, int b) { return wgts[a] > wgts[b]; });
+
+        using LIpair = std::pair<long,int>;
+        std::priority_queue<LIpair, std::vector<LIpair>, std::greater<LIpair> > least;
+        for (int p = 0; p < nprocs; ++p) {
+            least.push(LIpair(load[p], p));
+        }
+        for (int i : rest)
+        {
+            LIpair lp = least.top();
+            least.pop();
+            pmap[i] = lp.second;
+            lp.first += wgts[i];
+            least.push(lp);
+        }
+
+        if (verbose)
+        {
+            long kept = 0;
+            for (const auto& ov : overlaps) {
+                if (pmap[ov.box] == ov.proc) kept += ov.ncells;
+            }
+            long lmax = 0;
+            while (!least.empty()) {
+                lmax = std::max(lmax, least.top().first);
+                least.pop();
+            }
+            long old_total = old_boxes.numPts();
+            amrex::Print() << "REMAP efficiency: " << Real(total)/(Real(nprocs)*lmax)
+                           << ", fraction of the old cells kept in place: "
+                           << (old_total > 0 ? Real(kept)/old_total : 0.0) << '\n';
+        }
+
+        return pmap;
+    }
+}
+
+DistributionMapping
+DistributionMapping::makeRemap (const BoxArray&            boxes,
+                                const BoxArray&            old_boxes,
+                                const DistributionMapping& old_dm,
+                                Real                       tolerance)
+{
+    BL_PROFILE("makeRemap");
+
+    Array<long> cost(boxes.size());
+    for (int i = 0; i < boxes.size(); ++i) {
+        cost[i] = boxes[i].numPts();
+    }
+
+    int nprocs = ParallelDescriptor::NProcs();
+
+    return DistributionMapping(remap_processor_map(cost, boxes, old_boxes, old_dm, tolerance, nprocs));
+}
+
+DistributionMapping
+DistributionMapping::makeRemap (const Array<Real>&         rcost,
+                                const BoxArray&            boxes,
+                                const BoxArray&            old_boxes,
+                                const DistributionMapping& old_dm,
+                                Real                       tolerance)
+{
+    BL_PROFILE("makeRemap");
+
+    BL_ASSERT(rcost.size() == boxes.size());
+
+    Array<long> cost = scaled_cost(rcost);
+
+    int nprocs = ParallelDescriptor::NProcs();
+
+    return DistributionMapping(remap_processor_map(cost, boxes, old_boxes, old_dm, tolerance, nprocs));
+}
+
 std::ostream&
 operator<< (std::ostream&              os,
             const DistributionMapping& pmap)
@@ -1,4 +1,6 @@
 
+#include <limits>
+
 #include <AMReX_FabArrayBase.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Utility.H>
@@ -20,6 +22,8 @@ namespace amrex {
 // Set default values in Initialize()!!!
 //
 bool    FabArrayBase::do_async_sends;
+bool    FabArrayBase::fb_persistent;
+bool    FabArrayBase::first_touch;
 int     FabArrayBase::MaxComp;
 #if BL_SPACEDIM == 1
 IntVect FabArrayBase::mfiter_tile_size(1024000);
@@ -41,10 +45,13 @@ FabArrayBase::CFinfoCache          FabArrayBase::m_TheCrseFineCache;
 
 FabArrayBase::CacheStats           FabArrayBase::m_TAC_stats("TileArrayCache");
 FabArrayBase::CacheStats           FabArrayBase::m_FBC_stats("FBCache");
+FabArrayBase::CacheStats           FabArrayBase::m_FBP_stats("FBPersistentPlans");
 FabArrayBase::CacheStats           FabArrayBase::m_CPC_stats("CopyCache");
 FabArrayBase::CacheStats           FabArrayBase::m_FPinfo_stats("FillPatchCache");
 FabArrayBase::CacheStats           FabArrayBase::m_CFinfo_stats("CrseFineCache");
 
+MPI_Comm                           FabArrayBase::m_fb_persistent_comm = MPI_COMM_NULL;
+
 std::map<FabArrayBase::BDKey, int> FabArrayBase::m_BD_count;
 
 FabArrayBase::FabArrayStats        FabArrayBase::m_FA_stats;
@@ -78,6 +85,8 @@ FabArrayBase::Initialize ()
     //
     FabArrayBase::do_async_sends    = true;
     FabArrayBase::MaxComp           = 25;
+    FabArrayBase::fb_persistent     = false;
+    FabArrayBase::first_touch       = false;
 
     ParmParse pp("fabarray");
 
@@ -100,6 +109,17 @@ FabArrayBase::Initialize ()
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
     pp.query("do_async_sends",      FabArrayBase::do_async_sends);
+    pp.query("fb_persistent",       FabArrayBase::fb_persistent);
+    pp.query("first_touch",         FabArrayBase::first_touch);
+
+#ifdef BL_USE_MPI
+    if (FabArrayBase::fb_persistent && ParallelDescriptor::NProcs() > 1) {
+        BL_MPI_REQUIRE( MPI_Comm_dup(ParallelDescriptor::Communicator(),
+                                     &m_fb_persistent_comm) );
+    }
+#else
+    FabArrayBase::fb_persistent = false;
+#endif
 
     if (MaxComp < 1)
         MaxComp = 1;
@@ -117,6 +137,10 @@ FabArrayBase::Initialize ()
 		     ([] () -> MemProfiler::MemInfo {
 			 return {m_FBC_stats.bytes, m_FBC_stats.bytes_hwm};
 		     }));
+    MemProfiler::add(m_FBP_stats.name, std::function<MemProfiler::MemInfo()>
+		     ([] () -> MemProfiler::MemInfo {
+			 return {m_FBP_stats.bytes, m_FBP_stats.bytes_hwm};
+		     }));
     MemProfiler::add(m_CPC_stats.name, std::function<MemProfiler::MemInfo()>
 		     ([] () -> MemProfiler::MemInfo {
 			 return {m_CPC_stats.bytes, m_CPC_stats.bytes_hwm};
@@ -229,6 +253,27 @@ FabArrayBase::FB::bytes () const
     if (m_RcvVols)
 	cnt += FabArrayBase::bytesOfMapOfCopyComTagContainers(*m_RcvVols);
 
+    for (const auto& kv : m_persistent_plans)
+        cnt += kv.second->bytes() + amrex::gcc_map_node_extra_bytes;
+
+    return cnt;
+}
+
+long
+FabArrayBase::FBPersistentPlan::bytes () const
+{
+    long cnt = sizeof(FabArrayBase::FBPersistentPlan);
+
+    cnt += amrex::bytesOf(m_send_data) + amrex::bytesOf(m_send_size)
+        +  amrex::bytesOf(m_send_rank) + amrex::bytesOf(m_send_cctc)
+        +  amrex::bytesOf(m_send_reqs);
+    cnt += amrex::bytesOf(m_recv_data) + amrex::bytesOf(m_recv_size)
+        +  amrex::bytesOf(m_recv_from) + amrex::bytesOf(m_recv_cctc)
+        +  amrex::bytesOf(m_recv_reqs);
+
+    for (auto n : m_send_size) cnt += n;
+    for (auto n : m_recv_size) cnt += n;
+
     return cnt;
 }
 
@@ -981,6 +1026,13 @@ FabArrayBase::FB::define_epo (const FabArrayBase& fa)
 
 FabArrayBase::FB::~FB ()
 {
+    for (auto& kv : m_persistent_plans) {
+#ifdef BL_MEM_PROFILING
+        m_FBP_stats.bytes -= kv.second->bytes();
+#endif
+        m_FBP_stats.recordErase(kv.second->m_nuse);
+        delete kv.second;
+    }
     delete m_LocTags;
     delete m_SndTags;
     delete m_RcvTags;
@@ -988,6 +1040,133 @@ FabArrayBase::FB::~FB ()
     delete m_RcvVols;
 }
 
+FabArrayBase::FBPersistentPlan*
+FabArrayBase::FB::getPersistentPlan (std::size_t bytes_per_cell, int tag) const
+{
+    auto it = m_persistent_plans.find(bytes_per_cell);
+    if (it != m_persistent_plans.end())
+    {
+        if (it->second->m_in_use) return nullptr;
+        ++(it->second->m_nuse);
+        m_FBP_stats.recordUse();
+        return it->second;
+    }
+
+    FBPersistentPlan* new_plan = new FBPersistentPlan(*this, bytes_per_cell, tag);
+
+#ifdef BL_MEM_PROFILING
+    m_FBP_stats.bytes += new_plan->bytes();
+    m_FBP_stats.bytes_hwm = std::max(m_FBP_stats.bytes_hwm, m_FBP_stats.bytes);
+#endif
+
+    new_plan->m_nuse = 1;
+    m_FBP_stats.recordBuild();
+    m_FBP_stats.recordUse();
+
+    m_persistent_plans[bytes_per_cell] = new_plan;
+
+    return new_plan;
+}
+
+FabArrayBase::FBPersistentPlan::FBPersistentPlan (const FB& fb, std::size_t bytes_per_cell, int tag)
+    : m_bytes_per_cell(bytes_per_cell), m_tag(tag), m_in_use(false),
+      m_threadsafe_rcv(fb.m_threadsafe_rcv),
+      m_the_send_data(nullptr), m_the_recv_data(nullptr), m_nuse(0)
+{
+    BL_PROFILE("FabArrayBase::FBPersistentPlan::FBPersistentPlan()");
+
+#ifdef BL_USE_MPI
+    BL_ASSERT(m_fb_persistent_comm != MPI_COMM_NULL);
+
+    //
+    // The ordering of tags is the same on the sending and receiving sides.
+    // So one contiguous message per neighbor rank is all we need.
+    //
+    std::size_t tot_send = 0;
+    for (const auto& kv : *fb.m_SndTags)
+    {
+        std::size_t nbytes = 0;
+        for (const auto& cct : kv.second) {
+            nbytes += cct.sbox.numPts() * bytes_per_cell;
+        }
+        BL_ASSERT(nbytes < std::numeric_limits<int>::max());
+        if (nbytes > 0) {
+            m_send_size.push_back(static_cast<int>(nbytes));
+            m_send_rank.push_back(kv.first);
+            m_send_cctc.push_back(&kv.second);
+            tot_send += nbytes;
+        }
+    }
+
+    std::size_t tot_recv = 0;
+    for (const auto& kv : *fb.m_RcvTags)
+    {
+        std::size_t nbytes = 0;
+        for (const auto& cct : kv.second) {
+            nbytes += cct.dbox.numPts() * bytes_per_cell;
+        }
+        BL_ASSERT(nbytes < std::numeric_limits<int>::max());
+        if (nbytes > 0) {
+            m_recv_size.push_back(static_cast<int>(nbytes));
+            m_recv_from.push_back(kv.first);
+            m_recv_cctc.push_back(&kv.second);
+            tot_recv += nbytes;
+        }
+    }
+
+    const int N_snds = m_send_size.size();
+    const int N_rcvs = m_recv_size.size();
+
+    m_send_data.resize(N_snds, nullptr);
+    m_send_reqs.resize(N_snds, MPI_REQUEST_NULL);
+    m_recv_data.resize(N_rcvs, nullptr);
+    m_recv_reqs.resize(N_rcvs, MPI_REQUEST_NULL);
+
+    if (tot_send > 0)
+    {
+        m_the_send_data = static_cast<char*>(amrex::The_Arena()->alloc(tot_send));
+        char* p = m_the_send_data;
+        for (int j = 0; j < N_snds; ++j)
+        {
+            m_send_data[j] = p;
+            p += m_send_size[j];
+            BL_MPI_REQUIRE( MPI_Send_init(m_send_data[j], m_send_size[j], MPI_CHAR,
+                                          m_send_rank[j], m_tag, m_fb_persistent_comm,
+                                          &m_send_reqs[j]) );
+        }
+    }
+
+    if (tot_recv > 0)
+    {
+        m_the_recv_data = static_cast<char*>(amrex::The_Arena()->alloc(tot_recv));
+        char* p = m_the_recv_data;
+        for (int k = 0; k < N_rcvs; ++k)
+        {
+            m_recv_data[k] = p;
+            p += m_recv_size[k];
+            BL_MPI_REQUIRE( MPI_Recv_init(m_recv_data[k], m_recv_size[k], MPI_CHAR,
+                                          m_recv_from[k], m_tag, m_fb_persistent_comm,
+                                          &m_recv_reqs[k]) );
+        }
+    }
+#endif
+}
+
+FabArrayBase::FBPersistentPlan::~FBPersistentPlan ()
+{
+    BL_ASSERT(!m_in_use);
+#ifdef BL_USE_MPI
+    for (auto& req : m_send_reqs) {
+        if (req != MPI_REQUEST_NULL) MPI_Request_free(&req);
+    }
+    for (auto& req : m_recv_reqs) {
+        if (req != MPI_REQUEST_NULL) MPI_Request_free(&req);
+    }
+#endif
+    if (m_the_send_data) amrex::The_Arena()->free(m_the_send_data);
+    if (m_the_recv_data) amrex::The_Arena()->free(m_the_recv_data);
+}
+
 void
 FabArrayBase::flushFB (bool no_assertion) const
 {
@@ -1364,12 +1543,20 @@ FabArrayBase::Finalize ()
     FabArrayBase::flushFBCache();
     FabArrayBase::flushCPCache();
 
+#ifdef BL_USE_MPI
+    if (m_fb_persistent_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&m_fb_persistent_comm);
+        m_fb_persistent_comm = MPI_COMM_NULL;
+    }
+#endif
+
     FabArrayBase::flushTileArrayCache();
 
     if (ParallelDescriptor::IOProcessor() && amrex::system::verbose) {
 	m_FA_stats.print();
 	m_TAC_stats.print();
 	m_FBC_stats.print();
+	if (fb_persistent) m_FBP_stats.print();
 	m_CPC_stats.print();
 	m_FPinfo_stats.print();
 	m_CFinfo_stats.print();
@@ -1610,6 +1797,27 @@ FabArrayBase::updateBDKey ()
 }
 
 
+bool
+FabArrayBase::FillBoundary_trytest ()
+{
+    int busy;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+    { busy = fb_testing; fb_testing = 1; }
+
+    if (busy) return false;
+
+    FillBoundary_test();
+
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+    fb_testing = 0;
+
+    return true;
+}
+
 void
 FabArrayBase::WaitForAsyncSends (int                 N_snds,
                                  Array<MPI_Request>& send_reqs,
@@ -0,0 +1,324 @@
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <AMReX.H>
+#include <AMReX_FabCodec.H>
+
+namespace amrex {
+
+namespace
+{
+    //
+    // The chunk methods, stored in the first byte of a chunk.
+    //
+    const char MethodShuffleLZ = 1;
+    const char MethodQuantize  = 2;
+
+    //
+    // The LZ format is a sequence of [token, literals, offset, match length]
+    // records after the 8-byte uncompressed length.  The high and low nibbles
+    // of the token hold the literal length and the match length - MinMatch,
+    // with 15 meaning that more length bytes follow.  The last record only
+    // has literals.
+    //
+    const int  MinMatch  = 4;
+    const int  HashLog   = 16;
+    const long MaxOffset = 65535;
+
+    inline std::uint32_t read32 (const unsigned char* p)
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline int hash32 (std::uint32_t v)
+    {
+        return static_cast<int>((v * 2654435761U) >> (32 - HashLog));
+    }
+
+    void putLength (Array<char>& out, long len)
+    {
+        len -= 15;
+        while (len >= 255) {
+            out.push_back(static_cast<char>(255));
+            len -= 255;
+        }
+        out.push_back(static_cast<char>(len));
+    }
+
+    long getLength (const unsigned char* src, long nbytes, long& ip)
+    {
+        long len = 0;
+        unsigned char b;
+        do {
+            if (ip >= nbytes) {
+                amrex::Abort("FabCodec::LZDecompress: corrupt data");
+            }
+            b = src[ip++];
+            len += b;
+        } while (b == 255);
+        return len;
+    }
+
+    void putSequence (Array<char>& out, const unsigned char* lit, long nlit,
+                      long offset, long mlen)
+    {
+        const long m = (mlen > 0) ? mlen - MinMatch : 0;
+        const unsigned char token = (std::min(nlit, 15L) << 4) | std::min(m, 15L);
+        out.push_back(static_cast<char>(token));
+        if (nlit >= 15) putLength(out, nlit);
+        out.insert(out.end(), lit, lit + nlit);
+        if (mlen > 0) {
+            out.push_back(static_cast<char>(offset & 0xff));
+            out.push_back(static_cast<char>(offset >> 8));
+            if (m >= 15) putLength(out, m);
+        }
+    }
+
+    void putVarint (Array<unsigned char>& out, std::uint64_t v)
+    {
+        while (v >= 0x80) {
+            out.push_back(static_cast<unsigned char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(v));
+    }
+
+    std::uint64_t getVarint (const Array<unsigned char>& in, long& ip)
+    {
+        std::uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (ip >= static_cast<long>(in.size())) break;
+            const unsigned char b = in[ip++];
+            v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+            if (b < 0x80) return v;
+        }
+        amrex::Abort("FabCodec::Decompress: corrupt data");
+        return 0;
+    }
+
+    void compressShuffleLZ (const Real* data, long n, Array<char>& out)
+    {
+        const int  S  = sizeof(Real);
+        const long nb = n * S;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+        Array<unsigned char> buf(std::max(nb, 1L));
+        for (int b = 0; b < S; ++b) {
+            unsigned char* q = buf.dataPtr() + b*n;
+            for (long k = 0; k < n; ++k) {
+                q[k] = p[k*S + b];
+            }
+        }
+        out.push_back(MethodShuffleLZ);
+        FabCodec::LZCompress(buf.dataPtr(), nb, out);
+    }
+
+    //
+    // Returns false if some value cannot be stored within tolerance.
+    //
+    bool compressQuantize (const Real* data, long n, Real tolerance, Array<char>& out)
+    {
+        const Real step = 2 * tolerance;
+        if ( ! (tolerance > 0 && std::isfinite(step))) {
+            return false;
+        }
+
+        Array<unsigned char> vbytes;
+        vbytes.reserve(n);
+        std::int64_t qprev = 0;
+        for (long k = 0; k < n; ++k) {
+            const Real r = data[k] / step;
+            if ( ! (std::abs(r) < 4.0e18)) {   // ---- also catches NaN
+                return false;
+            }
+            const std::int64_t q = std::llround(r);
+            if ( ! (std::abs(data[k] - static_cast<Real>(q) * step) <= tolerance)) {
+                return false;
+            }
+            const std::int64_t d = q - qprev;
+            putVarint(vbytes, (static_cast<std::uint64_t>(d) << 1) ^ static_cast<std::uint64_t>(d >> 63));
+            qprev = q;
+        }
+
+        out.push_back(MethodQuantize);
+        const char* sp = reinterpret_cast<const char*>(&step);
+        out.insert(out.end(), sp, sp + sizeof(Real));
+        FabCodec::LZCompress(vbytes.dataPtr(), vbytes.size(), out);
+        return true;
+    }
+}
+
+void
+FabCodec::Compress (const Real* data,
+                    long        n,
+                    Type        type,
+                    Real        tolerance,
+                    Array<char>& out)
+{
+    const long start = out.size();
+    if (type == Lossy) {
+        if (compressQuantize(data, n, tolerance, out)) {
+            return;
+        }
+        out.resize(start);
+    }
+    compressShuffleLZ(data, n, out);
+}
+
+void
+FabCodec::Decompress (const char* chunk,
+                      long        nbytes,
+                      Real*       data,
+                      long        n)
+{
+    if (nbytes < 1) {
+        amrex::Abort("FabCodec::Decompress: empty chunk");
+    }
+
+    Array<unsigned char> buf;
+
+    if (chunk[0] == MethodShuffleLZ)
+    {
+        LZDecompress(chunk + 1, nbytes - 1, buf);
+        const int S = sizeof(Real);
+        if (static_cast<long>(buf.size()) != n * S) {
+            amrex::Abort("FabCodec::Decompress: wrong number of values");
+        }
+        unsigned char* p = reinterpret_cast<unsigned char*>(data);
+        for (int b = 0; b < S; ++b) {
+            const unsigned char* q = buf.dataPtr() + b*n;
+            for (long k = 0; k < n; ++k) {
+                p[k*S + b] = q[k];
+            }
+        }
+    }
+    else if (chunk[0] == MethodQuantize)
+    {
+        if (nbytes < 1 + static_cast<long>(sizeof(Real))) {
+            amrex::Abort("FabCodec::Decompress: corrupt data");
+        }
+        Real step;
+        std::memcpy(&step, chunk + 1, sizeof(Real));
+        LZDecompress(chunk + 1 + sizeof(Real), nbytes - 1 - sizeof(Real), buf);
+        long ip = 0;
+        std::int64_t q = 0;
+        for (long k = 0; k < n; ++k) {
+            const std::uint64_t z = getVarint(buf, ip);
+            q += static_cast<std::int64_t>(z >> 1) ^ -static_cast<std::int64_t>(z & 1);
+            data[k] = static_cast<Real>(q) * step;
+        }
+        if (ip != static_cast<long>(buf.size())) {
+            amrex::Abort("FabCodec::Decompress: wrong number of values");
+        }
+    }
+    else
+    {
+        amrex::Abort("FabCodec::Decompress: unknown chunk method");
+    }
+}
+
+void
+FabCodec::LZCompress (const unsigned char* src,
+                      long                 n,
+                      Array<char>&         out)
+{
+    const std::int64_t n64 = n;
+    const char* np = reinterpret_cast<const char*>(&n64);
+    out.insert(out.end(), np, np + sizeof(n64));
+
+    Array<long> table(1 << HashLog, -1);
+    long anchor = 0, i = 0;
+    const long last = n - MinMatch;  // ---- the last position a match can start
+
+    while (i <= last)
+    {
+        const std::uint32_t seq = read32(src + i);
+        const int h = hash32(seq);
+        const long cand = table[h];
+        table[h] = i;
+        if (cand >= 0 && i - cand <= MaxOffset && read32(src + cand) == seq)
+        {
+            long len = MinMatch;
+            while (i + len < n && src[cand + len] == src[i + len]) {
+                ++len;
+            }
+            putSequence(out, src + anchor, i - anchor, i - cand, len);
+            i += len;
+            anchor = i;
+        }
+        else
+        {
+            i += 1 + ((i - anchor) >> 6);  // ---- skip faster through data that do not compress
+        }
+    }
+
+    if (anchor < n) {
+        putSequence(out, src + anchor, n - anchor, 0, 0);
+    }
+}
+
+long
+FabCodec::LZDecompress (const char*    csrc,
+                        long           nbytes,
+                        Array<unsigned char>& dst)
+{
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(csrc);
+
+    std::int64_t n64;
+    if (nbytes < static_cast<long>(sizeof(n64))) {
+        amrex::Abort("FabCodec::LZDecompress: corrupt data");
+    }
+    std::memcpy(&n64, src, sizeof(n64));
+    const long n = n64;
+    if (n < 0) {
+        amrex::Abort("FabCodec::LZDecompress: corrupt data");
+    }
+    dst.resize(n);
+
+    long ip = sizeof(n64), op = 0;
+    while (op < n)
+    {
+        if (ip >= nbytes) {
+            amrex::Abort("FabCodec::LZDecompress: corrupt data");
+        }
+        const unsigned token = src[ip++];
+
+        long nlit = token >> 4;
+        if (nlit == 15) nlit += getLength(src, nbytes, ip);
+        if (nlit > n - op || nlit > nbytes - ip) {
+            amrex::Abort("FabCodec::LZDecompress: corrupt data");
+        }
+        std::memcpy(dst.dataPtr() + op, src + ip, nlit);
+        op += nlit;
+        ip += nlit;
+        if (op == n) break;
+
+        if (ip + 2 > nbytes) {
+            amrex::Abort("FabCodec::LZDecompress: corrupt data");
+        }
+        const long offset = src[ip] | (src[ip+1] << 8);
+        ip += 2;
+        long mlen = token & 15;
+        if (mlen == 15) mlen += getLength(src, nbytes, ip);
+        mlen += MinMatch;
+        if (offset == 0 || offset > op || mlen > n - op) {
+            amrex::Abort("FabCodec::LZDecompress: corrupt data");
+        }
+        //
+        // The match may overlap the bytes it produces, so copy byte by byte.
+        //
+        unsigned char* d = dst.dataPtr() + op;
+        for (long k = 0; k < mlen; ++k) {
+            d[k] = d[k - offset];
+        }
+        op += mlen;
+    }
+
+    return ip;
+}
+
+}
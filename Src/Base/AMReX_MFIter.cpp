@@ -1,3 +1,4 @@
+#include <thread>
 
 #include <AMReX_MFIter.H>
 #include <AMReX_FabArray.H>
@@ -18,7 +19,9 @@ MFIter::MFIter (const FabArrayBase& fabarray_,
     local_index_map(nullptr),
     tile_array(nullptr),
     local_tile_index_map(nullptr),
-    num_local_tiles(nullptr)
+    num_local_tiles(nullptr),
+    m_fb_fa(nullptr),
+    m_fb_ng(0)
 {
     Initialize();
 }
@@ -34,7 +37,9 @@ MFIter::MFIter (const FabArrayBase& fabarray_,
     local_index_map(nullptr),
     tile_array(nullptr),
     local_tile_index_map(nullptr),
-    num_local_tiles(nullptr)
+    num_local_tiles(nullptr),
+    m_fb_fa(nullptr),
+    m_fb_ng(0)
 {
     Initialize();
 }
@@ -51,7 +56,9 @@ MFIter::MFIter (const FabArrayBase& fabarray_,
     local_index_map(nullptr),
     tile_array(nullptr),
     local_tile_index_map(nullptr),
-    num_local_tiles(nullptr)
+    num_local_tiles(nullptr),
+    m_fb_fa(nullptr),
+    m_fb_ng(0)
 {
     Initialize();
 }
@@ -69,7 +76,9 @@ MFIter::MFIter (const BoxArray& ba, const DistributionMapping& dm, unsigned char
     local_index_map(nullptr),
     tile_array(nullptr),
     local_tile_index_map(nullptr),
-    num_local_tiles(nullptr)
+    num_local_tiles(nullptr),
+    m_fb_fa(nullptr),
+    m_fb_ng(0)
 {
     Initialize();
 }
@@ -87,7 +96,9 @@ MFIter::MFIter (const BoxArray& ba, const DistributionMapping& dm, bool do_tilin
     local_index_map(nullptr),
     tile_array(nullptr),
     local_tile_index_map(nullptr),
-    num_local_tiles(nullptr)
+    num_local_tiles(nullptr),
+    m_fb_fa(nullptr),
+    m_fb_ng(0)
 {
     Initialize();
 }
@@ -107,7 +118,9 @@ MFIter::MFIter (const BoxArray& ba, const DistributionMapping& dm,
     local_index_map(nullptr),
     tile_array(nullptr),
     local_tile_index_map(nullptr),
-    num_local_tiles(nullptr)
+    num_local_tiles(nullptr),
+    m_fb_fa(nullptr),
+    m_fb_ng(0)
 {
     Initialize();
 }
@@ -118,12 +131,14 @@ MFIter::MFIter (const FabArrayBase& fabarray_, const MFItInfo& info)
     fabArray(fabarray_),
     tile_size(info.tilesize),
     flags(info.do_tiling ? Tiling : 0),
-    dynamic(info.dynamic),
+    dynamic(info.dynamic && info.fb_fa == nullptr),
     index_map(nullptr),
     local_index_map(nullptr),
     tile_array(nullptr),
     local_tile_index_map(nullptr),
-    num_local_tiles(nullptr)
+    num_local_tiles(nullptr),
+    m_fb_fa(info.fb_fa),
+    m_fb_ng(info.fb_ng)
 {
     if (dynamic) {
 #ifdef _OPENMP
@@ -141,6 +156,19 @@ MFIter::MFIter (const FabArrayBase& fabarray_, const MFItInfo& info)
 
 MFIter::~MFIter ()
 {
+    //
+    // Other threads may still wait for ghost cells that only the master
+    // thread can unpack.
+    //
+    if (m_fb_fa && !ParallelDescriptor::MPIThreadSerialized() && OverlapCanTest())
+    {
+        for (int li = 0; li < m_fb_fa->local_size(); ++li) {
+            while (!m_fb_fa->FBLocalFabReady(li)) {
+                m_fb_fa->FillBoundary_trytest();
+            }
+        }
+    }
+
 #if BL_USE_TEAM
     if ( ! (flags & NoTeamBarrier) )
 	ParallelDescriptor::MyTeam().MemoryBarrier();
@@ -236,6 +264,115 @@ MFIter::Initialize ()
 	currentIndex = beginIndex;
 
 	typ = fabArray.boxArray().ixType();
+
+        if (m_fb_fa) OverlapInit();
+    }
+}
+
+void
+MFIter::OverlapInit ()
+{
+    //
+    // Make a private copy of our tiles with those not touching the ghost
+    // cells of m_fb_fa first.
+    //
+    m_fb_ta.reset(new FabArrayBase::TileArray);
+    FabArrayBase::TileArray& ta = *m_fb_ta;
+
+    const int ntiles = endIndex - beginIndex;
+    ta.indexMap.reserve(ntiles);
+    ta.localIndexMap.reserve(ntiles);
+    ta.localTileIndexMap.reserve(ntiles);
+    ta.numLocalTiles.reserve(ntiles);
+    ta.tileArray.reserve(ntiles);
+
+    Array<int> bndry;
+    for (int i = beginIndex; i < endIndex; ++i)
+    {
+        const int K = (*index_map)[i];
+        const Box& ccbx = amrex::enclosedCells(fabArray.box(K));
+        if (ccbx.contains(amrex::grow((*tile_array)[i], m_fb_ng))) {
+            ta.indexMap.push_back(K);
+            ta.localIndexMap.push_back((*local_index_map)[i]);
+            ta.localTileIndexMap.push_back((*local_tile_index_map)[i]);
+            ta.numLocalTiles.push_back((*num_local_tiles)[i]);
+            ta.tileArray.push_back((*tile_array)[i]);
+        } else {
+            bndry.push_back(i);
+        }
+    }
+
+    m_fb_first_bndry = ta.indexMap.size();
+
+    for (int i : bndry)
+    {
+        ta.indexMap.push_back((*index_map)[i]);
+        ta.localIndexMap.push_back((*local_index_map)[i]);
+        ta.localTileIndexMap.push_back((*local_tile_index_map)[i]);
+        ta.numLocalTiles.push_back((*num_local_tiles)[i]);
+        ta.tileArray.push_back((*tile_array)[i]);
+    }
+
+    ta.nuse = 0;
+    index_map            = &(ta.indexMap);
+    local_index_map      = &(ta.localIndexMap);
+    tile_array           = &(ta.tileArray);
+    local_tile_index_map = &(ta.localTileIndexMap);
+    num_local_tiles      = &(ta.numLocalTiles);
+
+    currentIndex = beginIndex = 0;
+    endIndex = ta.indexMap.size();
+
+    OverlapWait();
+}
+
+bool
+MFIter::OverlapCanTest ()
+{
+#ifdef _OPENMP
+    return ParallelDescriptor::MPIThreadSerialized() || omp_get_thread_num() == 0;
+#else
+    return true;
+#endif
+}
+
+void
+MFIter::OverlapWait ()
+{
+    if (currentIndex < m_fb_first_bndry || currentIndex >= endIndex) return;
+
+    //
+    // Pick a remaining tile whose fab has received all its ghost cells.
+    // The counts are checked without a lock.  If none is ready, one thread
+    // at a time calls MPI to unpack the messages that have arrived, while
+    // the others yield before checking again.  If MPI does not allow that
+    // from any thread, only the master thread does it.
+    //
+    FabArrayBase::TileArray& ta = *m_fb_ta;
+    int found = -1;
+    while (found < 0)
+    {
+        for (int i = currentIndex; i < endIndex; ++i) {
+            if (m_fb_fa->FBLocalFabReady(m_fb_fa->localindex(ta.indexMap[i]))) {
+                found = i;
+                break;
+            }
+        }
+        if (found < 0 && !(OverlapCanTest() && m_fb_fa->FillBoundary_trytest())) {
+            std::this_thread::yield();
+        }
+    }
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+
+    if (found != currentIndex)
+    {
+        std::swap(ta.indexMap[found],          ta.indexMap[currentIndex]);
+        std::swap(ta.localIndexMap[found],     ta.localIndexMap[currentIndex]);
+        std::swap(ta.localTileIndexMap[found], ta.localTileIndexMap[currentIndex]);
+        std::swap(ta.numLocalTiles[found],     ta.numLocalTiles[currentIndex]);
+        std::swap(ta.tileArray[found],         ta.tileArray[currentIndex]);
     }
 }
 
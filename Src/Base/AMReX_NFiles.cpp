@@ -118,6 +118,9 @@ NFilesIter::NFilesIter(const std::string &filename,
 		       const Array<int> &readranks,
                        bool setBuf)
 {
+  // ---- only the readRanks build this iterator, so they cannot agree
+  // ---- on a SeqNum.  use a fixed tag below the SeqNum range instead.
+  stReadTag = 999;
   isReading = true;
   myProc    = ParallelDescriptor::MyProc();
   nProcs    = ParallelDescriptor::NProcs();
@@ -47,6 +47,7 @@ extern "C" {
 namespace
 {
     static int call_mpi_finalize = 0;
+    static bool mpi_thread_serialized = true;
 }
 
 namespace amrex {
@@ -295,9 +296,24 @@ ParallelDescriptor::StartParallel (int*    argc,
     BL_MPI_REQUIRE( MPI_Initialized(&sflag) );
 
     if ( ! sflag) {
+#ifdef _OPENMP
+        // MFIter overlapping FillBoundary may call MPI from any thread, one at a time.
+        int provided;
+	BL_MPI_REQUIRE( MPI_Init_thread(argc, argv, MPI_THREAD_SERIALIZED, &provided) );
+#else
 	BL_MPI_REQUIRE( MPI_Init(argc, argv) );
+#endif
         call_mpi_finalize = 1;
     }
+
+#ifdef _OPENMP
+    {
+        // MPI may also have been initialized by someone else.
+        int provided;
+        BL_MPI_REQUIRE( MPI_Query_thread(&provided) );
+        mpi_thread_serialized = (provided >= MPI_THREAD_SERIALIZED);
+    }
+#endif
     
     BL_MPI_REQUIRE( MPI_Comm_dup(mpi_comm, &m_comm_all) );
 
@@ -2740,6 +2756,12 @@ ParallelDescriptor::EndTeams ()
 }
 
 
+bool
+ParallelDescriptor::MPIThreadSerialized ()
+{
+    return mpi_thread_serialized;
+}
+
 bool
 ParallelDescriptor::MPIOneSided ()
 {
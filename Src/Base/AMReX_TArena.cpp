@@ -0,0 +1,304 @@
+
+#include <algorithm>
+
+#include <AMReX_TArena.H>
+#include <AMReX_BLassert.H>
+#include <AMReX_Print.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace amrex {
+
+const int TArena::magic;
+const std::size_t TArena::DefaultHunkSize;
+
+TArena::TArena (std::size_t max_small, std::size_t hunk_size)
+    :
+    m_used(0)
+{
+    if (max_small == 0) max_small = DefaultMaxSmall;
+    m_nclasses = 1;
+    while (classSize(m_nclasses-1) < max_small) ++m_nclasses;
+
+    m_hunk = Arena::align(hunk_size == 0 ? DefaultHunkSize : hunk_size);
+
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    m_caches.resize(nthreads);
+    for (auto& tc : m_caches) {
+        tc.m_bins.resize(m_nclasses);
+    }
+    m_pool.resize(m_nclasses);
+
+    BL_ASSERT(sizeof(Header)%Arena::align_size == 0);
+}
+
+TArena::~TArena ()
+{
+    for (unsigned int i = 0, N = m_alloc.size(); i < N; i++)
+        ::operator delete(m_alloc[i]);
+}
+
+int
+TArena::sizeClass (std::size_t nbytes) const
+{
+    int c = 0;
+    while (classSize(c) < nbytes) ++c;
+    return c;
+}
+
+std::size_t
+TArena::binCapacity (int c) const
+{
+    return std::max(std::size_t(2), std::size_t(ThreadBinSize) / classSize(c));
+}
+
+TArena::ThreadCache*
+TArena::myCache ()
+{
+#ifdef _OPENMP
+    //
+    // Threads of nested parallel regions share thread numbers, so they
+    // have to go through the shared pool.
+    //
+    if (omp_get_level() > 1) return nullptr;
+    const int tid = omp_get_thread_num();
+    return (tid < static_cast<int>(m_caches.size())) ? &m_caches[tid] : nullptr;
+#else
+    return &m_caches[0];
+#endif
+}
+
+//
+// The caller must hold the amrex_tarena critical section.
+//
+void
+TArena::newHunk (int c)
+{
+    const std::size_t sz = blockSize(c);
+    const std::size_t N = std::max(m_hunk, sz);
+    char* p = static_cast<char*>(::operator new(N));
+    m_used += N;
+    m_alloc.push_back(p);
+    const std::size_t n = N/sz;
+    for (std::size_t i = 0; i < n; ++i) {
+        m_pool[c].push_back(p + (n-1-i)*sz);  // so that we hand out low addresses first
+    }
+}
+
+//
+// The caller must hold the amrex_tarena critical section.
+//
+void
+TArena::refill (int c, std::vector<void*>& bin)
+{
+    std::vector<void*>& pool = m_pool[c];
+    if (pool.empty()) newHunk(c);
+
+    const std::size_t n = std::min(std::max(std::size_t(1), binCapacity(c)/2), pool.size());
+    bin.insert(bin.end(), pool.end()-n, pool.end());
+    pool.resize(pool.size()-n);
+}
+
+//
+// The caller must hold the amrex_tarena critical section.
+//
+void
+TArena::drain (int c, std::vector<void*>& bin)
+{
+    const std::size_t n = bin.size()/2;
+    m_pool[c].insert(m_pool[c].end(), bin.begin(), bin.begin()+n);
+    bin.erase(bin.begin(), bin.begin()+n);
+}
+
+void*
+TArena::alloc (std::size_t nbytes)
+{
+    const std::size_t pbytes = Arena::align(nbytes == 0 ? 1 : nbytes);
+
+    Header* h = nullptr;
+    int c = -1;
+
+    ThreadCache* tc = myCache();
+    Stats* st = tc ? &tc->m_stats : &m_pool_stats;
+
+    if (pbytes <= classSize(m_nclasses-1))
+    {
+        c = sizeClass(pbytes);
+        if (tc)
+        {
+            std::vector<void*>& bin = tc->m_bins[c];
+            if (bin.empty())
+            {
+#ifdef _OPENMP
+#pragma omp critical (amrex_tarena)
+#endif
+                refill(c, bin);
+                ++st->nrefills;
+            }
+            else
+            {
+                ++st->ncache_hits;
+            }
+            h = static_cast<Header*>(bin.back());
+            bin.pop_back();
+        }
+        else
+        {
+#ifdef _OPENMP
+#pragma omp critical (amrex_tarena)
+#endif
+            {
+                if (m_pool[c].empty()) newHunk(c);
+                h = static_cast<Header*>(m_pool[c].back());
+                m_pool[c].pop_back();
+            }
+        }
+    }
+    else
+    {
+#ifdef _OPENMP
+#pragma omp critical (amrex_tarena_large)
+#endif
+        {
+            h = static_cast<Header*>(m_large.alloc(sizeof(Header) + pbytes));
+            ++st->nlarge;
+        }
+    }
+
+    h->m_class = c;
+    h->m_magic = magic;
+    h->m_size  = nbytes;
+
+    if (tc) {
+        ++st->nalloc;
+        st->bytes_in_use += nbytes;
+    } else {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        ++st->nalloc;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        st->bytes_in_use += nbytes;
+    }
+
+    return h+1;
+}
+
+void
+TArena::free (void* vp)
+{
+    if (vp == 0)
+        //
+        // Allow calls with NULL as allowed by C++ delete.
+        //
+        return;
+
+    Header* h = static_cast<Header*>(vp) - 1;
+
+    BL_ASSERT(h->m_magic == magic);
+    h->m_magic = 0;
+
+    const int c = h->m_class;
+    const long nbytes = h->m_size;
+
+    ThreadCache* tc = myCache();
+
+    if (c < 0)
+    {
+#ifdef _OPENMP
+#pragma omp critical (amrex_tarena_large)
+#endif
+        m_large.free(h);
+    }
+    else if (tc)
+    {
+        std::vector<void*>& bin = tc->m_bins[c];
+        bin.push_back(h);
+        if (bin.size() > binCapacity(c))
+        {
+#ifdef _OPENMP
+#pragma omp critical (amrex_tarena)
+#endif
+            drain(c, bin);
+            ++tc->m_stats.ndrains;
+        }
+    }
+    else
+    {
+#ifdef _OPENMP
+#pragma omp critical (amrex_tarena)
+#endif
+        m_pool[c].push_back(h);
+    }
+
+    if (tc) {
+        ++tc->m_stats.nfree;
+        tc->m_stats.bytes_in_use -= nbytes;
+    } else {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        ++m_pool_stats.nfree;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        m_pool_stats.bytes_in_use -= nbytes;
+    }
+}
+
+std::size_t
+TArena::heap_space_used () const
+{
+    return m_used + m_large.heap_space_used();
+}
+
+void
+TArena::PrintStats () const
+{
+    Stats tot = m_pool_stats;
+    for (auto const& tc : m_caches) {
+        tot.nalloc       += tc.m_stats.nalloc;
+        tot.nfree        += tc.m_stats.nfree;
+        tot.ncache_hits  += tc.m_stats.ncache_hits;
+        tot.nrefills     += tc.m_stats.nrefills;
+        tot.ndrains      += tc.m_stats.ndrains;
+        tot.nlarge       += tc.m_stats.nlarge;
+        tot.bytes_in_use += tc.m_stats.bytes_in_use;
+    }
+
+    long cached = 0;
+    for (auto const& tc : m_caches) {
+        for (int c = 0; c < m_nclasses; ++c) {
+            cached += tc.m_bins[c].size() * blockSize(c);
+        }
+    }
+    for (int c = 0; c < m_nclasses; ++c) {
+        cached += m_pool[c].size() * blockSize(c);
+    }
+
+    long heap = heap_space_used();
+    long heap_max = heap;
+    ParallelDescriptor::ReduceLongMax(heap_max, ParallelDescriptor::IOProcessorNumber());
+
+    amrex::Print() << "TArena stats on proc. " << ParallelDescriptor::IOProcessorNumber() << ":\n"
+                   << "    #allocs: "          << tot.nalloc
+                   << ", #frees: "             << tot.nfree
+                   << ", #thread cache hits: " << tot.ncache_hits
+                   << ", #refills: "           << tot.nrefills
+                   << ", #drains: "            << tot.ndrains
+                   << ", #large allocs: "      << tot.nlarge << "\n"
+                   << "    bytes in use: "     << tot.bytes_in_use
+                   << ", bytes in free lists: " << cached
+                   << ", heap space used: "    << heap
+                   << " (max over procs: "     << heap_max << ")\n";
+}
+
+}
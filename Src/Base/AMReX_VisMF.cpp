@@ -6,6 +6,17 @@
 #include <vector>
 #include <deque>
 #include <cerrno>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <AMReX_ccse-mpi.H>
 #include <AMReX_Utility.H>
@@ -13,6 +24,7 @@
 #include <AMReX_ParmParse.H>
 #include <AMReX_NFiles.H>
 #include <AMReX_FPC.H>
+#include <AMReX_FabCodec.H>
 
 namespace amrex {
 
@@ -21,6 +33,7 @@ static const char *FabFileSuffix = "_D_";
 static const char *TheFabOnDiskPrefix = "FabOnDisk:";
 
 std::map<std::string, VisMF::PersistentIFStream> VisMF::persistentIFStreams;
+std::multimap<std::string, VisMF::MappedFile> VisMF::mappedFiles;
 
 int VisMF::verbose(0);
 VisMF::Header::Version VisMF::currentVersion(VisMF::Header::Version_v1);
@@ -32,6 +45,8 @@ bool VisMF::checkFilePositions(false);
 bool VisMF::usePersistentIFStreams(false);
 bool VisMF::useSynchronousReads(false);
 bool VisMF::useDynamicSetSelection(true);
+bool VisMF::asyncWrite(false);
+Real VisMF::lossyTolerance(1.0e-6);
 
 long VisMF::ioBufferSize(VisMF::IO_Buffer_Size);
 
@@ -45,6 +60,180 @@ int VisMF::nMFFileInStreams(1);
 namespace
 {
     bool initialized = false;
+
+    //
+    // The background writer used by VisMF::AsyncWrite.  It does no MPI.
+    //
+    struct AsyncWriteJob
+    {
+        std::string             fileName;
+        long                    offset;
+        long                    nBytes;
+        std::unique_ptr<char[]> data;
+    };
+
+    std::thread               asyncThread;
+    std::mutex                asyncMutex;
+    std::condition_variable   asyncCV;
+    std::deque<AsyncWriteJob> asyncJobs;
+    bool                      asyncBusy = false;
+    bool                      asyncStop = false;
+    std::string               asyncFailedFile;
+
+    void AsyncWriterLoop ()
+    {
+        for(;;) {
+            AsyncWriteJob job;
+            {
+                std::unique_lock<std::mutex> lock(asyncMutex);
+                asyncCV.wait(lock, [] { return asyncStop || ! asyncJobs.empty(); });
+                if(asyncJobs.empty()) {
+                    return;
+                }
+                job = std::move(asyncJobs.front());
+                asyncJobs.pop_front();
+                asyncBusy = true;
+            }
+
+            // ---- the file was created by the first rank writing to it
+            std::fstream fs(job.fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+            if(fs.good()) {
+                fs.seekp(job.offset, std::ios::beg);
+                fs.write(job.data.get(), job.nBytes);
+                fs.close();
+            }
+            bool failed( ! fs.good());
+            job.data.reset();
+
+            {
+                std::lock_guard<std::mutex> lock(asyncMutex);
+                if(failed && asyncFailedFile.empty()) {
+                    asyncFailedFile = job.fileName;
+                }
+                asyncBusy = false;
+            }
+            asyncCV.notify_all();
+        }
+    }
+
+    //
+    // Set the ghost cells of each component to the average of the min and max over the valid region.
+    //
+    void SetGhostToMidpoint (const FabArray<FArrayBox> &mf)
+    {
+        FabArray<FArrayBox>* the_mf = const_cast<FabArray<FArrayBox>*>(&mf);
+
+        for(MFIter mfi(*the_mf); mfi.isValid(); ++mfi) {
+            const int idx(mfi.index());
+
+            for(int j(0); j < mf.nComp(); ++j) {
+                const Real valMin(mf[mfi].min(mf.box(idx), j));
+                const Real valMax(mf[mfi].max(mf.box(idx), j));
+                const Real val((valMin + valMax) / 2.0);
+
+                the_mf->get(mfi).setComplement(val, mf.box(idx), j, 1);
+            }
+        }
+    }
+
+    //
+    // Compress each component of each local fab into cdata, in MFIter order,
+    // and put the compressed sizes in hdr.  Returns the number of bytes.
+    //
+    long CompressFabs (const FabArray<FArrayBox> &mf, VisMF::Header &hdr,
+                       Real lossyTolerance, Array< Array<char> > &cdata)
+    {
+        BL_PROFILE("VisMF::CompressFabs");
+
+        const Array<int> &idxArray = mf.IndexArray();
+        const int nComp(mf.nComp());
+        const bool lossy(hdr.m_vers == VisMF::Header::CompressedLossy_v1);
+        const FabCodec::Type type(lossy ? FabCodec::Lossy : FabCodec::Lossless);
+
+        cdata.resize(idxArray.size());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for(int i = 0; i < idxArray.size(); ++i) {
+            const int idx(idxArray[i]);
+            const FArrayBox &fab = mf[idx];
+            const long npts(fab.box().numPts());
+            hdr.m_csize[idx].resize(nComp);
+            for(int n(0); n < nComp; ++n) {
+                Real tol(0.0);
+                if(lossy) {
+                    tol = lossyTolerance * (fab.max(n) - fab.min(n));
+                }
+                const long before(cdata[i].size());
+                FabCodec::Compress(fab.dataPtr(n), npts, type, tol, cdata[i]);
+                hdr.m_csize[idx][n] = cdata[i].size() - before;
+            }
+        }
+
+        long nBytes(0);
+        for(int i(0); i < cdata.size(); ++i) {
+            nBytes += cdata[i].size();
+        }
+        return nBytes;
+    }
+
+    //
+    // Read and decompress components [scomp, scomp+ncomp) of fab idx.  The
+    // stream has to be at the start of the fab.
+    //
+    void ReadCompressedFab (std::istream &is, const VisMF::Header &hdr, int idx,
+                            int scomp, int ncomp, Real *dst, long npts)
+    {
+        if(hdr.m_writtenRD != FPC::NativeRealDescriptor()) {
+            amrex::Error("VisMF:  compressed data were written with a different Real type or byte order");
+        }
+
+        const Array<long> &csize = hdr.m_csize[idx];
+        long skip(0), nBytes(0);
+        for(int n(0); n < scomp; ++n) {
+            skip += csize[n];
+        }
+        for(int n(scomp); n < scomp + ncomp; ++n) {
+            nBytes += csize[n];
+        }
+        if(skip > 0) {
+            is.seekg(skip, std::ios::cur);
+        }
+
+        Array<char> buf(std::max(nBytes, 1L));
+        is.read(buf.dataPtr(), nBytes);
+        if( ! is.good()) {
+            amrex::Error("VisMF:  read of compressed fab data failed");
+        }
+
+        long pos(0);
+        for(int n(0); n < ncomp; ++n) {
+            FabCodec::Decompress(buf.dataPtr() + pos, csize[scomp+n], dst + n*npts, npts);
+            pos += csize[scomp+n];
+        }
+    }
+
+    //
+    // Parse a Version_v1 fab header line into the written RealDescriptor,
+    // the box and the number of components.  Returns false for the old
+    // fab format, which FABio has to read.
+    //
+    bool ParseFabHeader (const std::string &hline, RealDescriptor &rd, Box &bx, int &nvar)
+    {
+        std::istringstream hss(hline);
+        char c;
+        hss >> c >> c >> c >> c;
+        if(c == ':') {
+            return false;
+        }
+        hss.putback(c);
+        hss >> rd >> bx >> nvar;
+        if(hss.fail()) {
+            amrex::Error("VisMF:  bad fab header:  " + hline);
+        }
+        return true;
+    }
 }
 
 void
@@ -82,6 +271,8 @@ VisMF::Initialize ()
     pp.query("usesynchronousreads", useSynchronousReads);
     pp.query("usedynamicsetselection", useDynamicSetSelection);
     pp.query("iobuffersize", ioBufferSize);
+    pp.query("asyncwrite", asyncWrite);
+    pp.query("lossytolerance", lossyTolerance);
 
     initialized = true;
 }
@@ -89,6 +280,19 @@ VisMF::Initialize ()
 void
 VisMF::Finalize ()
 {
+    VisMF::AsyncWait();
+    if(asyncThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(asyncMutex);
+            asyncStop = true;
+        }
+        asyncCV.notify_all();
+        asyncThread.join();
+        asyncStop = false;
+    }
+
+    VisMF::UnmapFiles();
+
     initialized = false;
 }
 
@@ -256,6 +460,71 @@ operator>> (std::istream&         is,
     return is;
 }
 
+static
+std::ostream&
+operator<< (std::ostream&               os,
+            const Array< Array<long> >& ar)
+{
+    long i(0), N(ar.size()), M = (N == 0) ? 0 : ar[0].size();
+
+    os << N << ',' << M << '\n';
+
+    for( ; i < N; ++i) {
+        BL_ASSERT(ar[i].size() == M);
+
+        for(long j(0); j < M; ++j) {
+            os << ar[i][j] << ',';
+        }
+        os << '\n';
+    }
+
+    if( ! os.good()) {
+        amrex::Error("Write of Array<Array<long>> failed");
+    }
+
+    return os;
+}
+
+static
+std::istream&
+operator>> (std::istream&         is,
+            Array< Array<long> >& ar)
+{
+    char ch;
+    long i(0), N, M;
+
+    is >> N >> ch >> M;
+
+    if( N < 0 ) {
+      amrex::Error("Expected a positive integer, N, got something else");
+    }
+    if( M < 0 ) {
+      amrex::Error("Expected a positive integer, M, got something else");
+    }
+    if( ch != ',' ) {
+      amrex::Error("Expected a ',' got something else");
+    }
+
+    ar.resize(N);
+
+    for( ; i < N; ++i) {
+        ar[i].resize(M);
+
+        for(long j = 0; j < M; ++j) {
+            is >> ar[i][j] >> ch;
+	    if( ch != ',' ) {
+	      amrex::Error("Expected a ',' got something else");
+	    }
+        }
+    }
+
+    if( ! is.good()) {
+        amrex::Error("Read of Array<Array<long>> failed");
+    }
+
+    return is;
+}
+
 std::ostream&
 operator<< (std::ostream        &os,
             const VisMF::Header &hd)
@@ -278,12 +547,18 @@ operator<< (std::ostream        &os,
     os << hd.m_fod      << '\n';
 
     if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       VisMF::Compressed(hd))
     {
       os << hd.m_min      << '\n';
       os << hd.m_max      << '\n';
     }
 
+    if(VisMF::Compressed(hd)) {
+      BL_ASSERT(hd.m_csize.size() == hd.m_ba.size());
+      os << hd.m_csize    << '\n';
+    }
+
     if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
       BL_ASSERT(hd.m_famin.size() == hd.m_ncomp);
       BL_ASSERT(hd.m_famin.size() == hd.m_famax.size());
@@ -310,6 +585,10 @@ operator<< (std::ostream        &os,
       }
     }
 
+    if(VisMF::Compressed(hd)) {    // ---- the codecs work on native Reals
+      os << FPC::NativeRealDescriptor() << '\n';
+    }
+
     os.flags(oflags);
     os.precision(oldPrec);
 
@@ -352,7 +631,8 @@ operator>> (std::istream  &is,
     BL_ASSERT(hd.m_ba.size() == hd.m_fod.size());
 
     if(hd.m_vers == VisMF::Header::Version_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1)
+       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       VisMF::Compressed(hd))
     {
       is >> hd.m_min;
       is >> hd.m_max;
@@ -360,6 +640,11 @@ operator>> (std::istream  &is,
       BL_ASSERT(hd.m_ba.size() == hd.m_max.size());
     }
 
+    if(VisMF::Compressed(hd)) {
+      is >> hd.m_csize;
+      BL_ASSERT(hd.m_ba.size() == hd.m_csize.size());
+    }
+
     if(hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1) {
       char ch;
       hd.m_famin.resize(hd.m_ncomp);
@@ -377,10 +662,7 @@ operator>> (std::istream  &is,
 	}
       }
     }
-    if(hd.m_vers == VisMF::Header::NoFabHeader_v1       ||
-       hd.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-       hd.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
-    {
+    if(VisMF::NoFabHeader(hd)) {
       is >> hd.m_writtenRD;
     }
 
@@ -541,6 +823,95 @@ VisMF::readFAB (int idx,
     return VisMF::readFAB(idx, m_fafabname, m_hdr, ncomp);
 }
 
+FArrayBox*
+VisMF::mapFAB (int idx,
+               int whichComp) const
+{
+    BL_PROFILE("VisMF::mapFAB");
+    BL_ASSERT(0 <= idx && idx < m_hdr.m_ba.size());
+    BL_ASSERT(whichComp >= -1 && whichComp < m_hdr.m_ncomp);
+
+    Box fab_box(m_hdr.m_ba[idx]);
+    if(m_hdr.m_ngrow) {
+        fab_box.grow(m_hdr.m_ngrow);
+    }
+    const int  nComp(whichComp == -1 ? m_hdr.m_ncomp : 1);
+    const int  sComp(whichComp == -1 ? 0 : whichComp);
+    const long nPts(fab_box.numPts());
+
+    std::string FullName(VisMF::DirName(m_fafabname));
+    FullName += m_hdr.m_fod[idx].m_name;
+
+    MappedFile mfile;
+#ifdef _OPENMP
+#pragma omp critical (amrex_vismf_mapfile)
+#endif
+    {
+        MappedFile &mf = VisMF::MapFile(FullName);
+        if(m_mapped.insert(std::make_pair(FullName, mf.addr)).second) {
+          ++mf.nuse;
+        }
+        mfile = mf;
+    }
+
+    const char *fabPtr = mfile.addr + m_hdr.m_fod[idx].m_head;
+    const char *endPtr = mfile.addr + mfile.length;
+    RealDescriptor rd(m_hdr.m_writtenRD);
+
+    if(m_hdr.m_vers == Header::Version_v1) {
+      // ---- parse the fab header for the format and the start of the data
+      const char *nl = static_cast<const char *>(memchr(fabPtr, '\n', endPtr - fabPtr));
+      if(nl == nullptr) {
+        amrex::Error("VisMF::mapFAB:  bad fab header in " + FullName);
+      }
+      Box bx;
+      int nvar;
+      if( ! ParseFabHeader(std::string(fabPtr, nl - fabPtr), rd, bx, nvar)) {
+        return VisMF::readFAB(idx, m_fafabname, m_hdr, whichComp);  // ---- the old fab format
+      }
+      if(bx != fab_box || nvar != m_hdr.m_ncomp) {
+        amrex::Error("VisMF::mapFAB:  bad fab header in " + FullName);
+      }
+      fabPtr = nl + 1;
+    }
+
+    if(VisMF::Compressed(m_hdr)) {
+      const Array<long> &csize = m_hdr.m_csize[idx];
+      for(int n(0); n < sComp; ++n) {
+        fabPtr += csize[n];
+      }
+      FArrayBox *fab = new FArrayBox(fab_box, nComp);
+      for(int n(0); n < nComp; ++n) {
+        if(fabPtr + csize[sComp+n] > endPtr) {
+          amrex::Error("VisMF::mapFAB:  file too short:  " + FullName);
+        }
+        FabCodec::Decompress(fabPtr, csize[sComp+n], fab->dataPtr(n), nPts);
+        fabPtr += csize[sComp+n];
+      }
+      return fab;
+    }
+
+    const long compBytes(nPts * rd.numBytes());
+    fabPtr += sComp * compBytes;
+    if(fabPtr + nComp * compBytes > endPtr) {
+      amrex::Error("VisMF::mapFAB:  file too short:  " + FullName);
+    }
+
+    if(rd == FPC::NativeRealDescriptor()) {
+      if(reinterpret_cast<std::uintptr_t>(fabPtr) % alignof(Real) == 0) {
+        return new FArrayBox(fab_box, nComp, reinterpret_cast<Real *>(const_cast<char *>(fabPtr)));
+      }
+      FArrayBox *fab = new FArrayBox(fab_box, nComp);
+      memcpy(fab->dataPtr(), fabPtr, nComp * compBytes);
+      return fab;
+    }
+
+    FArrayBox *fab = new FArrayBox(fab_box, nComp);
+    RealDescriptor::convertToNativeFormat(fab->dataPtr(), nComp * nPts,
+                                          const_cast<char *>(fabPtr), rd);
+    return fab;
+}
+
 std::string
 VisMF::BaseName (const std::string& filename)
 {
@@ -646,6 +1017,10 @@ VisMF::Header::Header (const FabArray<FArrayBox>& mf,
       return;
     }
 
+    if(version == Compressed_v1 || version == CompressedLossy_v1) {
+      m_csize.resize(m_ba.size());
+    }
+
     if(version == NoFabHeaderFAMinMax_v1) {
       // ---- calculate FabArray min max values only
       m_min.clear();
@@ -892,6 +1267,12 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
     BL_ASSERT(currentVersion != VisMF::Header::Undefined_v1);
 
+    if(asyncWrite && FArrayBox::getFormat() != FABio::FAB_ASCII &&
+                     FArrayBox::getFormat() != FABio::FAB_8BIT)
+    {
+      return VisMF::AsyncWrite(mf, mf_name, set_ghost);
+    }
+
     // ---- add stream retry
     // ---- add stream buffer (to nfiles)
     RealDescriptor *whichRD;
@@ -905,19 +1286,7 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     bool doConvert(*whichRD != FPC::NativeRealDescriptor());
 
     if(set_ghost) {
-        FabArray<FArrayBox>* the_mf = const_cast<FabArray<FArrayBox>*>(&mf);
-
-        for(MFIter mfi(*the_mf); mfi.isValid(); ++mfi) {
-            const int idx(mfi.index());
-
-            for(int j(0); j < mf.nComp(); ++j) {
-                const Real valMin(mf[mfi].min(mf.box(idx), j));
-                const Real valMax(mf[mfi].max(mf.box(idx), j));
-                const Real val((valMin + valMax) / 2.0);
-
-                the_mf->get(mfi).setComplement(val, mf.box(idx), j, 1);
-            }
-        }
+        SetGhostToMidpoint(mf);
     }
 
     int coordinatorProc(ParallelDescriptor::IOProcessorNumber());
@@ -931,10 +1300,27 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 
     bool oldHeader(currentVersion == VisMF::Header::Version_v1);
 
+    // ---- compress before writing so only the writes are serialized
+    bool compressed(VisMF::Compressed(hdr));
+    Array< Array<char> > cdata;
+    if(compressed) {
+      CompressFabs(mf, hdr, lossyTolerance, cdata);
+    }
+
       if(useDynamicSetSelection) {
         nfi.SetDynamic();
       }
       for( ; nfi.ReadyToWrite(); ++nfi) {
+          if(compressed) {
+            int i(0);
+            for(MFIter mfi(mf); mfi.isValid(); ++mfi, ++i) {
+              hdr.m_fod[mfi.index()].m_head = VisMF::FileOffset(nfi.Stream());
+              nfi.Stream().write(cdata[i].dataPtr(), cdata[i].size());
+              bytesWritten += cdata[i].size();
+            }
+            nfi.Stream().flush();
+            continue;
+          }
 	  // ---- find the total number of bytes including fab headers if needed
           const FABio &fio = FArrayBox::getFABio();
           int whichRDBytes(whichRD->numBytes()), nFABs(0);
@@ -1022,7 +1408,8 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
     }
 
     if(currentVersion == VisMF::Header::Version_v1 ||
-       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1)
+       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       compressed)
     {
       hdr.CalculateMinMax(mf, coordinatorProc);
     }
@@ -1038,6 +1425,189 @@ VisMF::Write (const FabArray<FArrayBox>&    mf,
 }
 
 
+long
+VisMF::AsyncWrite (const FabArray<FArrayBox>&    mf,
+                   const std::string& mf_name,
+                   bool               set_ghost)
+{
+    BL_PROFILE("VisMF::AsyncWrite");
+    BL_ASSERT(mf_name[mf_name.length() - 1] != '/');
+    BL_ASSERT(currentVersion != VisMF::Header::Undefined_v1);
+
+    if(FArrayBox::getFormat() == FABio::FAB_ASCII ||
+       FArrayBox::getFormat() == FABio::FAB_8BIT)
+    {
+      amrex::Abort("VisMF::AsyncWrite:  ASCII and 8BIT fab formats are not supported.");
+    }
+
+    RealDescriptor *whichRD;
+    if(FArrayBox::getFormat() == FABio::FAB_NATIVE) {
+      whichRD = FPC::NativeRealDescriptor().clone();
+    } else if(FArrayBox::getFormat() == FABio::FAB_NATIVE_32) {
+      whichRD = FPC::Native32RealDescriptor().clone();
+    } else if(FArrayBox::getFormat() == FABio::FAB_IEEE_32) {
+      whichRD = FPC::Ieee32NormalRealDescriptor().clone();
+    }
+    bool doConvert(*whichRD != FPC::NativeRealDescriptor());
+    int whichRDBytes(whichRD->numBytes());
+
+    if(set_ghost) {
+      SetGhostToMidpoint(mf);
+    }
+
+    const int myProc(ParallelDescriptor::MyProc());
+    const int nProcs(ParallelDescriptor::NProcs());
+    const int coordinatorProc(ParallelDescriptor::IOProcessorNumber());
+    const bool oldHeader(currentVersion == VisMF::Header::Version_v1);
+    const FABio &fio = FArrayBox::getFABio();
+
+    std::string filePrefix(mf_name + FabFileSuffix);
+
+    bool calcMinMax(false);
+    VisMF::Header hdr(mf, VisMF::NFiles, currentVersion, calcMinMax);
+
+    bool compressed(VisMF::Compressed(hdr));
+    Array< Array<char> > cdata;
+    if(compressed) {
+      CompressFabs(mf, hdr, lossyTolerance, cdata);
+    }
+
+    // ---- the staging positions of our fabs, in the order Write uses
+    Array<long> fabPosition;
+    long myBytes(0);
+    for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+      const FArrayBox &fab = mf[mfi];
+      if(compressed) {
+        fabPosition.push_back(myBytes);
+        myBytes += cdata[fabPosition.size() - 1].size();
+        continue;
+      }
+      fabPosition.push_back(myBytes);
+      if(oldHeader) {
+        std::stringstream hss;
+        fio.write_header(hss, fab, fab.nComp());
+        myBytes += hss.tellp();
+      }
+      myBytes += fab.box().numPts() * mf.nComp() * whichRDBytes;
+    }
+
+    std::unique_ptr<char[]> stage(new char[std::max(myBytes, 1L)]);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for(int i = 0; i < fabPosition.size(); ++i) {
+      const FArrayBox &fab = mf[mf.IndexArray()[i]];
+      char *afPtr = stage.get() + fabPosition[i];
+      if(compressed) {
+        memcpy(afPtr, cdata[i].dataPtr(), cdata[i].size());
+        continue;
+      }
+      int hLength(0);
+      if(oldHeader) {
+        std::stringstream hss;
+        fio.write_header(hss, fab, fab.nComp());
+        hLength = hss.tellp();
+        memcpy(afPtr, hss.str().c_str(), hLength);  // ---- the fab header
+      }
+      long writeDataItems(fab.box().numPts() * mf.nComp());
+      if(doConvert) {
+        RealDescriptor::convertFromNativeFormat(static_cast<void *> (afPtr + hLength),
+                                                writeDataItems,
+                                                fab.dataPtr(), *whichRD);
+      } else {
+        memcpy(afPtr + hLength, fab.dataPtr(), writeDataItems * whichRDBytes);
+      }
+    }
+
+    // ---- our offset is the number of bytes of the ranks before us in our file,
+    // ---- which matches the static set selection order used by FindOffsets
+    const int nFiles(NFilesIter::ActualNFiles(nOutFiles));
+    const int myFileNumber(NFilesIter::FileNumber(nFiles, myProc, groupSets));
+    const std::string myFileName(NFilesIter::FileName(myFileNumber, filePrefix));
+
+    Array<long> allBytes(nProcs, 0);
+#ifdef BL_USE_MPI
+    BL_MPI_REQUIRE( MPI_Allgather(&myBytes, 1, ParallelDescriptor::Mpi_typemap<long>::type(),
+                                  allBytes.dataPtr(), 1, ParallelDescriptor::Mpi_typemap<long>::type(),
+                                  ParallelDescriptor::Communicator()) );
+#else
+    allBytes[0] = myBytes;
+#endif
+
+    long myOffset(0);
+    bool firstInFile(true);
+    for(int i(0); i < myProc; ++i) {
+      if(NFilesIter::FileNumber(nFiles, i, groupSets) == myFileNumber) {
+        myOffset += allBytes[i];
+        firstInFile = false;
+      }
+    }
+
+    if(compressed) {    // ---- FindOffsets gathers these
+      cdata.clear();
+      for(int i = 0; i < fabPosition.size(); ++i) {
+        hdr.m_fod[mf.IndexArray()[i]].m_head = myOffset + fabPosition[i];
+      }
+    }
+
+    // ---- create and truncate the files before anyone writes to them
+    if(firstInFile) {
+      std::ofstream ofs(myFileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+      if( ! ofs.good()) {
+        amrex::FileOpenFailed(myFileName);
+      }
+    }
+    ParallelDescriptor::Barrier("VisMF::AsyncWrite");
+
+    if(myBytes > 0) {
+      std::lock_guard<std::mutex> lock(asyncMutex);
+      if( ! asyncThread.joinable()) {
+        asyncThread = std::thread(AsyncWriterLoop);
+      }
+      AsyncWriteJob job;
+      job.fileName = myFileName;
+      job.offset   = myOffset;
+      job.nBytes   = myBytes;
+      job.data     = std::move(stage);
+      asyncJobs.push_back(std::move(job));
+    }
+    asyncCV.notify_all();
+
+    // ---- the header does not depend on the data being on disk
+    if(currentVersion == VisMF::Header::Version_v1 ||
+       currentVersion == VisMF::Header::NoFabHeaderMinMax_v1 ||
+       compressed)
+    {
+      hdr.CalculateMinMax(mf, coordinatorProc);
+    }
+
+    NFilesIter nfi(nOutFiles, filePrefix, groupSets, false);
+    VisMF::FindOffsets(mf, filePrefix, hdr, groupSets, currentVersion, false, nfi);
+
+    long bytesWritten = myBytes + VisMF::WriteHeader(mf_name, hdr, coordinatorProc);
+
+    delete whichRD;
+
+    return bytesWritten;
+}
+
+void
+VisMF::AsyncWait ()
+{
+    BL_PROFILE("VisMF::AsyncWait");
+
+    std::string failedFile;
+    {
+        std::unique_lock<std::mutex> lock(asyncMutex);
+        asyncCV.wait(lock, [] { return asyncJobs.empty() && ! asyncBusy; });
+        std::swap(failedFile, asyncFailedFile);
+    }
+    if( ! failedFile.empty()) {
+        amrex::FileOpenFailed(failedFile);
+    }
+}
+
 void
 VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
 		    const std::string &filePrefix,
@@ -1056,6 +1626,81 @@ VisMF::FindOffsets (const FabArray<FArrayBox> &mf,
       coordinatorProc = nfi.CoordinatorProc();
     }
 
+    if(whichVersion == VisMF::Header::Compressed_v1 ||
+       whichVersion == VisMF::Header::CompressedLossy_v1)
+    {
+      // ---- the offsets and compressed sizes are only known by the writers
+      const int nComps(mf.nComp());
+      const Array<int> &pmap = mf.DistributionMap().ProcessorMap();
+
+#ifdef BL_USE_MPI
+      Array<int> nmtags(nProcs,0);
+      Array<int> offset(nProcs,0);
+
+      for(int i(0), N(mf.size()); i < N; ++i) {
+        nmtags[pmap[i]] += 1 + nComps;
+      }
+
+      for(int i(1), N(offset.size()); i < N; ++i) {
+        offset[i] = offset[i-1] + nmtags[i-1];
+      }
+
+      Array<long> senddata(std::max(nmtags[myProc], 1));
+
+      int ioffset(0);
+
+      for(MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        senddata[ioffset++] = hdr.m_fod[mfi.index()].m_head;
+        for(int n(0); n < nComps; ++n) {
+          senddata[ioffset++] = hdr.m_csize[mfi.index()][n];
+        }
+      }
+
+      BL_ASSERT(ioffset == nmtags[myProc]);
+
+      Array<long> recvdata(mf.size() * (1 + nComps));
+
+      BL_MPI_REQUIRE( MPI_Gatherv(senddata.dataPtr(),
+                                  nmtags[myProc],
+                                  ParallelDescriptor::Mpi_typemap<long>::type(),
+                                  recvdata.dataPtr(),
+                                  nmtags.dataPtr(),
+                                  offset.dataPtr(),
+                                  ParallelDescriptor::Mpi_typemap<long>::type(),
+                                  coordinatorProc,
+                                  ParallelDescriptor::Communicator()) );
+
+      if(myProc == coordinatorProc) {
+        for(int j(0), N(mf.size()); j < N; ++j) {
+          const int i(pmap[j]);
+          hdr.m_fod[j].m_head = recvdata[offset[i]++];
+          hdr.m_csize[j].resize(nComps);
+          for(int n(0); n < nComps; ++n) {
+            hdr.m_csize[j][n] = recvdata[offset[i]++];
+          }
+        }
+      }
+#endif /*BL_USE_MPI*/
+
+      if(myProc == coordinatorProc) {
+        Array<int> fileNumbers;
+        if(useDynamicSetSelection) {
+          fileNumbers = nfi.FileNumbersWritten();
+        } else {
+          int nFiles(NFilesIter::ActualNFiles(nOutFiles));
+          fileNumbers.resize(nProcs);
+          for(int i(0); i < fileNumbers.size(); ++i) {
+            fileNumbers[i] = NFilesIter::FileNumber(nFiles, i, groupSets);
+          }
+        }
+        for(int j(0), N(mf.size()); j < N; ++j) {
+          hdr.m_fod[j].m_name = VisMF::BaseName(NFilesIter::FileName(fileNumbers[pmap[j]], filePrefix));
+        }
+      }
+
+      return;
+    }
+
     if(FArrayBox::getFormat() == FABio::FAB_ASCII ||
        FArrayBox::getFormat() == FABio::FAB_8BIT)
     {
@@ -1258,6 +1903,14 @@ VisMF::VisMF (const std::string &fafab_name)
 
 VisMF::~VisMF ()
 {
+    if( ! m_mapped.empty()) {
+#ifdef _OPENMP
+#pragma omp critical (amrex_vismf_mapfile)
+#endif
+      for(const auto &fa : m_mapped) {
+        VisMF::ReleaseFile(fa.first, fa.second);
+      }
+    }
 }
 
 
@@ -1287,6 +1940,12 @@ VisMF::readFAB (int                  idx,
       } else {
         fab->readFrom(*infs, whichComp);
       }
+    } else if(VisMF::Compressed(hdr)) {
+      if(whichComp == -1) {    // ---- read all components
+        ReadCompressedFab(*infs, hdr, idx, 0, hdr.m_ncomp, fab->dataPtr(), fab->box().numPts());
+      } else {                 // ---- only this component's chunk is read
+        ReadCompressedFab(*infs, hdr, idx, whichComp, 1, fab->dataPtr(), fab->box().numPts());
+      }
     } else {
       if(whichComp == -1) {    // ---- read all components
 	if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
@@ -1331,7 +1990,9 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
     std::ifstream *infs = VisMF::OpenStream(FullName);
     infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
 
-    if(NoFabHeader(hdr)) {
+    if(VisMF::Compressed(hdr)) {
+      ReadCompressedFab(*infs, hdr, idx, 0, fab.nComp(), fab.dataPtr(), fab.box().numPts());
+    } else if(NoFabHeader(hdr)) {
       if(hdr.m_writtenRD == FPC::NativeRealDescriptor()) {
         infs->read((char *) fab.dataPtr(), fab.nBytes());
       } else {
@@ -1347,6 +2008,144 @@ VisMF::readFAB (FabArray<FArrayBox> &mf,
 }
 
 
+void
+VisMF::readFABRegion (FArrayBox           &dst,
+                      int                  idx,
+                      const std::string   &mf_name,
+                      const VisMF::Header &hdr,
+                      const Array<int>    &comps)
+{
+    BL_PROFILE("VisMF::readFABRegion");
+    Box fab_box(hdr.m_ba[idx]);
+    if(hdr.m_ngrow) {
+        fab_box.grow(hdr.m_ngrow);
+    }
+    const Box &sb = dst.box();
+    const long nPts(fab_box.numPts());
+    BL_ASSERT(fab_box.contains(sb));
+    BL_ASSERT(dst.nComp() == comps.size());
+
+    std::string FullName(VisMF::DirName(mf_name));
+    FullName += hdr.m_fod[idx].m_name;
+
+    std::ifstream *infs = VisMF::OpenStream(FullName);
+    infs->seekg(hdr.m_fod[idx].m_head, std::ios::beg);
+
+    if(VisMF::Compressed(hdr)) {
+      // ---- only the chunks of the requested components are read
+      const std::streampos fabStart(infs->tellg());
+      FArrayBox tmp(fab_box, 1);
+      for(int n(0); n < comps.size(); ++n) {
+        infs->seekg(fabStart);
+        ReadCompressedFab(*infs, hdr, idx, comps[n], 1, tmp.dataPtr(), nPts);
+        dst.copy(tmp, sb, 0, sb, n, 1);
+      }
+      VisMF::CloseStream(FullName);
+      return;
+    }
+
+    RealDescriptor rd(hdr.m_writtenRD);
+    if(hdr.m_vers == Header::Version_v1) {
+      std::string hline;
+      std::getline(*infs, hline);
+      Box bx;
+      int nvar;
+      if( ! ParseFabHeader(hline, rd, bx, nvar)) {    // ---- the old fab format
+        VisMF::CloseStream(FullName);
+        for(int n(0); n < comps.size(); ++n) {
+          FArrayBox *fab = VisMF::readFAB(idx, mf_name, hdr, comps[n]);
+          dst.copy(*fab, sb, 0, sb, n, 1);
+          delete fab;
+        }
+        return;
+      }
+      if(bx != fab_box || nvar != hdr.m_ncomp) {
+        amrex::Error("VisMF::readFABRegion:  bad fab header in " + FullName);
+      }
+    }
+
+    const std::streampos dataStart(infs->tellg());
+    const long rdBytes(rd.numBytes());
+    const bool doConvert(rd != FPC::NativeRealDescriptor());
+    //
+    // The region is read in runs that are contiguous in the file.  A run
+    // is a row in x, extended over y (and z) as long as the region spans
+    // the whole fab in the lower directions.  runStarts holds the first
+    // cell of every run.
+    //
+    Box runStarts(sb);
+    long runLen(1);
+    for(int d(0); d < BL_SPACEDIM; ++d) {
+      runLen *= sb.length(d);
+      runStarts.setBig(d, sb.smallEnd(d));
+      if(sb.length(d) != fab_box.length(d)) {
+        break;
+      }
+    }
+
+    Array<char> buf(doConvert ? runLen * rdBytes : 0);
+    for(int n(0); n < comps.size(); ++n) {
+      const long compOffset(comps[n] * nPts);
+      for(IntVect iv(runStarts.smallEnd()); iv <= runStarts.bigEnd(); runStarts.next(iv)) {
+        infs->seekg(dataStart + static_cast<std::streamoff>((compOffset + fab_box.index(iv)) * rdBytes));
+        Real *dptr = dst.dataPtr(n) + sb.index(iv);
+        if(doConvert) {
+          infs->read(buf.dataPtr(), runLen * rdBytes);
+          RealDescriptor::convertToNativeFormat(dptr, runLen, buf.dataPtr(), rd);
+        } else {
+          infs->read(reinterpret_cast<char *>(dptr), runLen * rdBytes);
+        }
+      }
+    }
+    if( ! infs->good()) {
+      amrex::Error("VisMF::readFABRegion:  read failed:  " + FullName);
+    }
+
+    VisMF::CloseStream(FullName);
+}
+
+
+void
+VisMF::ReadRegion (FabArray<FArrayBox> &fafab,
+                   const Box           &region,
+                   const Array<int>    &comps) const
+{
+    BL_PROFILE("VisMF::ReadRegion");
+    for(int n(0); n < comps.size(); ++n) {
+      if(comps[n] < 0 || comps[n] >= m_hdr.m_ncomp) {
+        amrex::Abort("VisMF::ReadRegion:  bad component");
+      }
+    }
+
+    fafab.clear();
+    //
+    // The parts of the valid boxes on disk in the region, in file order.
+    //
+    std::vector< std::pair<int,Box> > isects = m_hdr.m_ba.intersections(region);
+    std::sort(isects.begin(), isects.end(),
+              [] (const std::pair<int,Box> &a, const std::pair<int,Box> &b)
+                 { return a.first < b.first; });
+    if(isects.empty() || comps.empty()) {
+      return;
+    }
+
+    BoxList bl;
+    const int nIsects(isects.size());
+    Array<int> srcIndex(nIsects);
+    for(int i(0); i < nIsects; ++i) {
+      bl.push_back(isects[i].second);
+      srcIndex[i] = isects[i].first;
+    }
+    BoxArray rba(bl);
+    DistributionMapping dm(rba);
+    fafab.define(rba, dm, comps.size(), 0);
+
+    for(MFIter mfi(fafab); mfi.isValid(); ++mfi) {
+      VisMF::readFABRegion(fafab[mfi], srcIndex[mfi.index()], m_fafabname, m_hdr, comps);
+    }
+}
+
+
 void
 VisMF::Read (FabArray<FArrayBox> &mf,
              const std::string   &mf_name,
@@ -1399,7 +2198,8 @@ VisMF::Read (FabArray<FArrayBox> &mf,
   int nProcs(ParallelDescriptor::NProcs());
   bool noFabHeader(NoFabHeader(hdr));
 
-  if(noFabHeader && useSynchronousReads) {
+  // ---- compressed fabs do not have a fixed size, so they are read one by one
+  if(noFabHeader && ! VisMF::Compressed(hdr) && useSynchronousReads) {
 
     // ---- This code is only for reading in file order
     bool doConvert(hdr.m_writtenRD != FPC::NativeRealDescriptor());
@@ -1930,7 +2730,8 @@ VisMF::clear ()
 bool VisMF::NoFabHeader(const VisMF::Header &hdr) {
   if(hdr.m_vers == VisMF::Header::NoFabHeader_v1       ||
     hdr.m_vers == VisMF::Header::NoFabHeaderMinMax_v1 ||
-    hdr.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1)
+    hdr.m_vers == VisMF::Header::NoFabHeaderFAMinMax_v1 ||
+    VisMF::Compressed(hdr))
   {
     return true;
   }
@@ -1938,6 +2739,12 @@ bool VisMF::NoFabHeader(const VisMF::Header &hdr) {
 }
 
 
+bool VisMF::Compressed(const VisMF::Header &hdr) {
+  return (hdr.m_vers == VisMF::Header::Compressed_v1 ||
+          hdr.m_vers == VisMF::Header::CompressedLossy_v1);
+}
+
+
 VisMF::PersistentIFStream::PersistentIFStream()
     :
     pstr(0),
@@ -2010,4 +2817,79 @@ void VisMF::CloseAllStreams() {
   VisMF::persistentIFStreams.clear();
 }
 
+
+VisMF::MappedFile &VisMF::MapFile(const std::string &fileName)
+{
+    int fd(open(fileName.c_str(), O_RDONLY));
+    if(fd < 0) {
+      amrex::FileOpenFailed(fileName);
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+      amrex::FileOpenFailed(fileName);
+    }
+#ifdef __APPLE__
+    const long mtime_nsec(st.st_mtimespec.tv_nsec);
+#else
+    const long mtime_nsec(st.st_mtim.tv_nsec);
+#endif
+
+    // ---- reuse a mapping only if the file has not changed since
+    auto range = mappedFiles.equal_range(fileName);
+    for(auto mfIter = range.first; mfIter != range.second; ++mfIter) {
+      const MappedFile &mf = mfIter->second;
+      if(mf.dev == st.st_dev && mf.ino == st.st_ino && mf.length == st.st_size &&
+         mf.mtime_sec == st.st_mtime && mf.mtime_nsec == mtime_nsec)
+      {
+        close(fd);
+        return mfIter->second;
+      }
+    }
+
+    if(st.st_size == 0) {
+      amrex::Error("VisMF::MapFile:  empty file " + fileName);
+    }
+
+    MappedFile mfile;
+    mfile.length     = st.st_size;
+    mfile.dev        = st.st_dev;
+    mfile.ino        = st.st_ino;
+    mfile.mtime_sec  = st.st_mtime;
+    mfile.mtime_nsec = mtime_nsec;
+    mfile.nuse       = 0;
+    // ---- private and writable, so FABs viewing it may be modified in memory
+    void *addr = mmap(nullptr, mfile.length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if(addr == MAP_FAILED) {
+      amrex::Error("VisMF::MapFile:  mmap failed for " + fileName);
+    }
+    mfile.addr = static_cast<char *>(addr);
+    close(fd);
+
+    return mappedFiles.insert(std::make_pair(fileName, mfile))->second;
+}
+
+
+void VisMF::ReleaseFile(const std::string &fileName, const char *addr)
+{
+    // ---- the mapping is gone if UnmapFiles has been called
+    auto range = mappedFiles.equal_range(fileName);
+    for(auto mfIter = range.first; mfIter != range.second; ++mfIter) {
+      if(mfIter->second.addr == addr) {
+        if(--mfIter->second.nuse == 0) {
+          munmap(mfIter->second.addr, mfIter->second.length);
+          mappedFiles.erase(mfIter);
+        }
+        return;
+      }
+    }
+}
+
+
+void VisMF::UnmapFiles() {
+  for(auto mfIter = mappedFiles.begin(); mfIter != mappedFiles.end(); ++mfIter) {
+    munmap(mfIter->second.addr, mfIter->second.length);
+  }
+  mappedFiles.clear();
+}
+
 }
@@ -104,6 +104,7 @@ extern "C" {
 namespace amrex {
 
 bool AmrData::verbose = false;
+bool AmrData::useMappedFabs = false;
 int  AmrData::skipPltLines  = 0;
 int  AmrData::sBoundaryWidth = 0;
 
@@ -1577,6 +1578,56 @@ void AmrData::FillInterior(FArrayBox &dest, int level, const Box &subbox) {
 }
 
 
+// ---------------------------------------------------------------
+void AmrData::ReadRegion(MultiFab &destMultiFab, int level, const Box &region,
+                         const Array<string> &varNames)
+{
+  BL_ASSERT(level >= 0 && level <= finestLevel);
+  if(fileType == Amrvis::FAB || (fileType == Amrvis::MULTIFAB && level == 0)) {
+    amrex::Abort("AmrData::ReadRegion:  not supported for FAB and MULTIFAB files");
+  }
+
+  int nVars(varNames.size());
+  Array<int> whichVisMF(nVars), whichVisMFComp(nVars);
+  for(int iv(0); iv < nVars; ++iv) {
+    int compIndex(StateNumber(varNames[iv]));
+    whichVisMF[iv]     = compIndexToVisMFMap[compIndex];
+    whichVisMFComp[iv] = compIndexToVisMFComponentMap[compIndex];
+  }
+
+  destMultiFab.clear();
+
+  // ---- one read for the variables in each VisMF.  the visMFs at a level
+  // ---- have the same boxArray, so the parts have the same layout
+  Array<int> done(nVars, false);
+  for(int iv(0); iv < nVars; ++iv) {
+    if(done[iv]) {
+      continue;
+    }
+    Array<int> comps, destComps;
+    for(int jv(iv); jv < nVars; ++jv) {
+      if(whichVisMF[jv] == whichVisMF[iv]) {
+        comps.push_back(whichVisMFComp[jv]);
+        destComps.push_back(jv);
+        done[jv] = true;
+      }
+    }
+
+    MultiFab part;
+    visMF[level][whichVisMF[iv]]->ReadRegion(part, region, comps);
+    if(part.size() == 0) {
+      return;  // ---- region misses the grids
+    }
+    if(destMultiFab.size() == 0) {
+      destMultiFab.define(part.boxArray(), part.DistributionMap(), nVars, 0);
+    }
+    for(int ic(0); ic < comps.size(); ++ic) {
+      MultiFab::Copy(destMultiFab, part, ic, destComps[ic], 1, 0);
+    }
+  }
+}
+
+
 // ---------------------------------------------------------------
 int AmrData::NumDeriveFunc() const {
   return (plotVars.size());
@@ -1721,8 +1772,13 @@ bool AmrData::DefineFab(int level, int componentIndex, int fabIndex) {
   if( ! dataGridsDefined[level][componentIndex][fabIndex]) {
     int whichVisMF(compIndexToVisMFMap[componentIndex]);
     int whichVisMFComponent(compIndexToVisMFComponentMap[componentIndex]);
-    dataGrids[level][componentIndex]->setFab(fabIndex,
-                visMF[level][whichVisMF]->readFAB(fabIndex, whichVisMFComponent));
+    if(useMappedFabs) {  // ---- no read or copy, pages are read when touched
+      dataGrids[level][componentIndex]->setFab(fabIndex,
+                  visMF[level][whichVisMF]->mapFAB(fabIndex, whichVisMFComponent));
+    } else {
+      dataGrids[level][componentIndex]->setFab(fabIndex,
+                  visMF[level][whichVisMF]->readFAB(fabIndex, whichVisMFComponent));
+    }
     dataGridsDefined[level][componentIndex][fabIndex] = true;
   }
   return true;
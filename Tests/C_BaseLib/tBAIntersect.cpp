@@ -0,0 +1,153 @@
+//
+// Benchmark of the BoxArray intersection queries on the ba.* files.
+//
+//   tBAIntersect.ex [files="ba.60 ba.213"] [ngrow=n] [check=0|1]
+//
+// For every file this times building the spatial index, and intersections(),
+// complementIn() and contains() of every box grown by ngrow cells (what the
+// FillBoundary and copy metadata are built from).  The same is done for a
+// version of the BoxArray in which every eighth box is chopped into small
+// boxes, so that the box sizes vary widely.  With check=1 the intersections
+// of the smaller BoxArrays are compared with a brute-force search.
+//
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <AMReX.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_ParallelDescriptor.H>
+
+using namespace amrex;
+
+static
+long
+brute_force (const BoxArray& ba, int ngrow)
+{
+    long cnt = 0;
+    for (int j = 0; j < ba.size(); j++)
+    {
+        const Box& bx = amrex::grow(ba[j], ngrow);
+        for (int i = 0; i < ba.size(); i++)
+        {
+            if (bx.intersects(ba[i]))
+                cnt++;
+        }
+    }
+    return cnt;
+}
+
+static
+void
+bench (const BoxArray& ba, const std::string& name, int ngrow, bool check)
+{
+    ba.clear_hash_bin();
+
+    Real beg = ParallelDescriptor::second();
+    ba.intersects(ba[0]);
+    const Real t_build = ParallelDescriptor::second() - beg;
+
+    beg = ParallelDescriptor::second();
+    long cnt = 0;
+    std::vector< std::pair<int,Box> > isects;
+    for (int j = 0; j < ba.size(); j++)
+    {
+        ba.intersections(amrex::grow(ba[j], ngrow), isects);
+        cnt += isects.size();
+    }
+    const Real t_isects = ParallelDescriptor::second() - beg;
+
+    beg = ParallelDescriptor::second();
+    long ncomplement = 0;
+    for (int j = 0; j < ba.size(); j++)
+    {
+        ncomplement += ba.complementIn(amrex::grow(ba[j], ngrow)).size();
+    }
+    const Real t_complement = ParallelDescriptor::second() - beg;
+
+    beg = ParallelDescriptor::second();
+    int ncontained = 0;
+    for (int j = 0; j < ba.size(); j++)
+    {
+        if (ba.contains(ba[j], true))
+            ncontained++;
+    }
+    const Real t_contains = ParallelDescriptor::second() - beg;
+
+    std::cout << name << ":  " << ba.size() << " boxes, " << cnt << " intersections\n"
+              << "    build index   = " << t_build << '\n'
+              << "    intersections = " << t_isects << '\n'
+              << "    complementIn  = " << t_complement << "  (" << ncomplement << " boxes)\n"
+              << "    contains      = " << t_contains
+              << (ncontained == ba.size() ? "" : "  ***** FAILED")
+              << std::endl;
+
+    if (check && ba.size() <= 20000)
+    {
+        const long bf = brute_force(ba, ngrow);
+        std::cout << "    brute force   = " << bf
+                  << (bf == cnt ? "  (ok)" : "  ***** FAILED") << std::endl;
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+
+    ParmParse pp;
+    std::vector<std::string> files;
+    if (pp.countval("files") > 0)
+    {
+        pp.getarr("files", files);
+    }
+    else
+    {
+        files = { "ba.60", "ba.213", "ba.mac.294", "ba.3865", "ba.5034",
+                  "ba.15456", "ba.15784", "ba.23925", "ba.25600", "ba.95860" };
+    }
+    int ngrow = 1;
+    pp.query("ngrow", ngrow);
+    int check = 0;
+    pp.query("check", check);
+
+    for (const auto& file : files)
+    {
+        std::ifstream ifs(file.c_str(), std::ios::in);
+        if (!ifs.good())
+        {
+            std::cout << "Cannot open " << file << std::endl;
+            continue;
+        }
+
+        BoxArray ba;
+        ba.readFrom(ifs);
+
+        bench(ba, file, ngrow, check);
+        //
+        // Chop every eighth box into boxes of at most 8 cells on a side.
+        //
+        BoxList bl;
+        for (int i = 0; i < ba.size(); i++)
+        {
+            if (i % 8 == 0)
+            {
+                BoxList chopped(ba[i]);
+                chopped.maxSize(8);
+                bl.join(chopped);
+            }
+            else
+            {
+                bl.push_back(ba[i]);
+            }
+        }
+        BoxArray mixed(bl);
+
+        bench(mixed, file + " (mixed sizes)", ngrow, check);
+    }
+
+    amrex::Finalize();
+}
@@ -0,0 +1,124 @@
+//
+// A test of FillBoundary() of several FabArrays at once.
+//
+//   mpirun -np 4 tFBMulti.ex [fabarray.do_async_sends=0] [fabarray.fb_persistent=1]
+//
+// Three MultiFabs with different numbers of components are filled in one
+// call, for all the components and for some of them, with and without the
+// cross stencil and periodicity.  The ghost cells must be the same as
+// those filled by FillBoundary() of each MultiFab on its own.
+//
+
+#include <iostream>
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_ParallelDescriptor.H>
+
+using namespace amrex;
+
+static
+void
+SetValid (MultiFab& mf, int iter)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox& fab = mf[mfi];
+        fab.setVal(-1.0);
+        const Box& bx = mfi.validbox();
+        for (int n = 0; n < mf.nComp(); ++n) {
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                fab(iv,n) = AMREX_D_TERM(iv[0], + 1000.0*iv[1], + 1.e6*iv[2])
+                    + 0.1*n + 0.01*iter + 1.e-4*mf.nComp();
+            }
+        }
+    }
+}
+
+static
+Real
+MaxDiff (const MultiFab& a, const MultiFab& b)
+{
+    Real r = 0.0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        FArrayBox d(a[mfi].box(), a.nComp());
+        d.copy(a[mfi]);
+        d.minus(b[mfi]);
+        r = std::max(r, d.norm(0,0,a.nComp()));
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(63,63,63)));
+    BoxArray ba(domain);
+    ba.maxSize(16);
+    DistributionMapping dm(ba);
+
+    RealBox rb(AMREX_D_DECL(0.0,0.0,0.0), AMREX_D_DECL(1.0,1.0,1.0));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, &rb, 0, is_per);
+
+    const int nmf = 3;
+    const int ncomp[nmf] = {1, 3, 2};
+    const int ngrow = 2;
+
+    Array<std::unique_ptr<MultiFab> > a(nmf), b(nmf);
+    Array<FabArray<FArrayBox>*> pa(nmf);
+    for (int i = 0; i < nmf; ++i) {
+        a[i].reset(new MultiFab(ba, dm, ncomp[i], ngrow));
+        b[i].reset(new MultiFab(ba, dm, ncomp[i], ngrow));
+        pa[i] = a[i].get();
+    }
+
+    int nfail = 0;
+
+    for (int iter = 0; iter < 8; ++iter)
+    {
+        const bool cross = (iter % 2 == 1);
+        const bool per   = (iter % 4 >= 2);
+        const Periodicity& period = per ? geom.periodicity() : Periodicity::NonPeriodic();
+
+        for (int i = 0; i < nmf; ++i) {
+            SetValid(*a[i], iter);
+            SetValid(*b[i], iter);
+        }
+
+        if (iter < 4) {
+            MultiFab::FillBoundary(pa, period, cross);
+            for (int i = 0; i < nmf; ++i) {
+                b[i]->FillBoundary(period, cross);
+            }
+        } else {
+            // The last component of each.
+            Array<int> scomps, ncomps(nmf, 1);
+            for (int i = 0; i < nmf; ++i) {
+                scomps.push_back(ncomp[i]-1);
+            }
+            MultiFab::FillBoundary(pa, scomps, ncomps, period, cross);
+            for (int i = 0; i < nmf; ++i) {
+                b[i]->FillBoundary(scomps[i], 1, period, cross);
+            }
+        }
+
+        Real diff = 0.0;
+        for (int i = 0; i < nmf; ++i) {
+            diff = std::max(diff, MaxDiff(*a[i], *b[i]));
+        }
+        if (diff != 0.0) ++nfail;
+
+        amrex::Print() << "iter " << iter << " cross " << cross << " periodic " << per
+                       << " max diff " << diff << "\n";
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
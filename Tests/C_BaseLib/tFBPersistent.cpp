@@ -0,0 +1,122 @@
+//
+// A test of FillBoundary() with persistent requests.
+//
+//   mpirun -np 4 tFBPersistent.ex
+//
+// The persistent plans are turned on here.  The same data are filled
+// with and without them, call after call, for all the components and
+// for some of them, with and without the cross stencil and periodicity.
+// The ghost cells must be the same.
+//
+
+#include <iostream>
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+static
+void
+SetValid (MultiFab& mf, int iter)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox& fab = mf[mfi];
+        fab.setVal(-1.0);
+        const Box& bx = mfi.validbox();
+        for (int n = 0; n < mf.nComp(); ++n) {
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                fab(iv,n) = AMREX_D_TERM(iv[0], + 1000.0*iv[1], + 1.e6*iv[2]) + 0.1*n + 0.01*iter;
+            }
+        }
+    }
+}
+
+//
+// Turn the persistent plans on before FabArrayBase reads its parameters.
+//
+static
+void
+AddParameters ()
+{
+    ParmParse pp("fabarray");
+    pp.add("fb_persistent", 1);
+}
+
+static
+Real
+MaxDiff (const MultiFab& a, const MultiFab& b)
+{
+    Real r = 0.0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        FArrayBox d(a[mfi].box(), a.nComp());
+        d.copy(a[mfi]);
+        d.minus(b[mfi]);
+        r = std::max(r, d.norm(0,0,a.nComp()));
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv,true,MPI_COMM_WORLD,AddParameters);
+
+    const bool persistent = FabArrayBase::fb_persistent;
+    if (!persistent) {
+        amrex::Print() << "the persistent plans need MPI, so both paths are the same\n";
+    }
+
+    Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(63,63,63)));
+    BoxArray ba(domain);
+    ba.maxSize(16);
+    DistributionMapping dm(ba);
+
+    RealBox rb(AMREX_D_DECL(0.0,0.0,0.0), AMREX_D_DECL(1.0,1.0,1.0));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, &rb, 0, is_per);
+
+    const int ncomp = 3;
+    const int ngrow = 2;
+
+    MultiFab a(ba, dm, ncomp, ngrow);
+    MultiFab b(ba, dm, ncomp, ngrow);
+
+    int nfail = 0;
+
+    for (int iter = 0; iter < 8; ++iter)
+    {
+        const bool cross = (iter % 2 == 1);
+        const bool per   = (iter % 4 >= 2);
+        const Periodicity& period = per ? geom.periodicity() : Periodicity::NonPeriodic();
+
+        SetValid(a, iter);
+        SetValid(b, iter);
+
+        FabArrayBase::fb_persistent = persistent;
+        a.FillBoundary(period, cross);
+        a.FillBoundary(1, 2, period, cross);
+
+        FabArrayBase::fb_persistent = false;
+        b.FillBoundary(period, cross);
+        b.FillBoundary(1, 2, period, cross);
+
+        const Real diff = MaxDiff(a, b);
+        if (diff != 0.0) ++nfail;
+
+        amrex::Print() << "iter " << iter << " cross " << cross << " periodic " << per
+                       << " max diff " << diff << "\n";
+    }
+
+    FabArrayBase::fb_persistent = persistent;
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
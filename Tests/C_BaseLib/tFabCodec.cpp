@@ -0,0 +1,141 @@
+//
+// A round-trip test of FabCodec.
+//
+//   tFabCodec.ex
+//
+// Random, smooth, constant, non-finite, incompressible and empty data are
+// compressed and decompressed.  Lossless chunks must give back the same
+// bits.  Lossy chunks must be within the tolerance, except that values
+// that are not finite must come back bit for bit, because such chunks
+// are stored losslessly.
+//
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <AMReX.H>
+#include <AMReX_FabCodec.H>
+#include <AMReX_Utility.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+static
+bool
+RoundTrip (const std::string& name, const Array<Real>& data,
+           FabCodec::Type type, Real tolerance)
+{
+    const long n = data.size();
+
+    Array<char> chunk;
+    FabCodec::Compress(data.dataPtr(), n, type, tolerance, chunk);
+
+    Array<Real> back(std::max(n,1L), 0.0);
+    FabCodec::Decompress(chunk.dataPtr(), chunk.size(), back.dataPtr(), n);
+
+    bool ok = true;
+    Real maxerr = 0.0;
+    for (long k = 0; k < n; ++k)
+    {
+        if (type == FabCodec::Lossless || !std::isfinite(data[k])) {
+            if (std::memcmp(&data[k], &back[k], sizeof(Real)) != 0) ok = false;
+        } else {
+            const Real err = std::abs(back[k] - data[k]);
+            maxerr = std::max(maxerr, err);
+            if (!(err <= tolerance)) ok = false;
+        }
+    }
+
+    amrex::Print() << name << (type == FabCodec::Lossless ? "  lossless" : "  lossy")
+                   << "  n = " << n << "  bytes = " << chunk.size()
+                   << "  max error = " << maxerr
+                   << (ok ? "  ok" : "  FAILED") << "\n";
+    return ok;
+}
+
+static
+bool
+LZRoundTrip (const std::string& name, const Array<unsigned char>& bytes)
+{
+    Array<char> out;
+    FabCodec::LZCompress(bytes.dataPtr(), bytes.size(), out);
+    Array<unsigned char> back;
+    const long nread = FabCodec::LZDecompress(out.dataPtr(), out.size(), back);
+    const bool ok = (nread == static_cast<long>(out.size())) && (back == bytes);
+    amrex::Print() << name << "  LZ  n = " << bytes.size() << "  bytes = " << out.size()
+                   << (ok ? "  ok" : "  FAILED") << "\n";
+    return ok;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    const long n = 100000;
+    const Real tol = 1.e-6;
+
+    int nfail = 0;
+
+    std::vector<std::pair<std::string,Array<Real> > > cases;
+
+    {
+        Array<Real> a(n);
+        for (auto& x : a) x = amrex::Random();
+        cases.push_back(std::make_pair(std::string("random"), a));
+    }
+    {
+        Array<Real> a(n);
+        for (long k = 0; k < n; ++k) a[k] = 1.5 + std::sin(1.e-3*k);
+        cases.push_back(std::make_pair(std::string("smooth"), a));
+    }
+    {
+        cases.push_back(std::make_pair(std::string("constant"), Array<Real>(n, 3.25)));
+    }
+    {
+        Array<Real> a(n);
+        for (long k = 0; k < n; ++k) a[k] = std::cos(1.e-2*k);
+        a[10]   = std::numeric_limits<Real>::quiet_NaN();
+        a[100]  = std::numeric_limits<Real>::infinity();
+        a[1000] = -std::numeric_limits<Real>::infinity();
+        cases.push_back(std::make_pair(std::string("nan/inf"), a));
+    }
+    {
+        // Random bits, including some that are not finite.
+        std::mt19937_64 gen(42);
+        Array<Real> a(n);
+        for (auto& x : a) {
+            const std::uint64_t bits = gen();
+            std::memcpy(&x, &bits, std::min(sizeof(Real), sizeof(bits)));
+        }
+        cases.push_back(std::make_pair(std::string("incompressible"), a));
+    }
+    {
+        cases.push_back(std::make_pair(std::string("empty"), Array<Real>()));
+    }
+
+    for (auto const& c : cases) {
+        if (!RoundTrip(c.first, c.second, FabCodec::Lossless, 0.0)) ++nfail;
+        if (!RoundTrip(c.first, c.second, FabCodec::Lossy,    tol)) ++nfail;
+    }
+
+    {
+        std::mt19937 gen(7);
+        Array<unsigned char> bytes(n);
+        for (auto& b : bytes) b = static_cast<unsigned char>(gen());
+        if (!LZRoundTrip("incompressible", bytes)) ++nfail;
+        if (!LZRoundTrip("empty", Array<unsigned char>())) ++nfail;
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,136 @@
+//
+// A test of MFIter overlapping the loop with FillBoundary_nowait().
+//
+//   mpirun -np 4 tMFIterOverlap.ex [fabarray.fb_persistent=1]
+//
+// A seven point Laplacian of a MultiFab is computed with the tiles
+// handed out as the ghost cells arrive, with and without tiling and
+// periodicity, and with FillBoundary() done before the loop.  The
+// results and the ghost cells must be the same.
+//
+
+#include <iostream>
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_ParallelDescriptor.H>
+
+using namespace amrex;
+
+static
+void
+SetValid (MultiFab& mf, int iter)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox& fab = mf[mfi];
+        fab.setVal(-1.0);
+        const Box& bx = mfi.validbox();
+        for (int n = 0; n < mf.nComp(); ++n) {
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                fab(iv,n) = AMREX_D_TERM(iv[0]*iv[0], + 1000.0*iv[1], + 1.e6*iv[2]*iv[2])
+                    + 0.1*n + 0.01*iter;
+            }
+        }
+    }
+}
+
+static
+void
+Laplacian (const FArrayBox& phi, FArrayBox& lap, const Box& bx, int ncomp)
+{
+    for (int n = 0; n < ncomp; ++n) {
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            Real r = -2.0*BL_SPACEDIM*phi(iv,n);
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                const IntVect e = IntVect::TheDimensionVector(d);
+                r += phi(iv+e,n) + phi(iv-e,n);
+            }
+            lap(iv,n) = r;
+        }
+    }
+}
+
+static
+Real
+MaxDiff (const MultiFab& a, const MultiFab& b)
+{
+    Real r = 0.0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        FArrayBox d(a[mfi].box(), a.nComp());
+        d.copy(a[mfi]);
+        d.minus(b[mfi]);
+        r = std::max(r, d.norm(0,0,a.nComp()));
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(63,63,63)));
+    BoxArray ba(domain);
+    ba.maxSize(16);
+    DistributionMapping dm(ba);
+
+    RealBox rb(AMREX_D_DECL(0.0,0.0,0.0), AMREX_D_DECL(1.0,1.0,1.0));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, &rb, 0, is_per);
+
+    const int ncomp = 2;
+    const int ngrow = 1;
+
+    MultiFab a(ba, dm, ncomp, ngrow), lap_a(ba, dm, ncomp, 0);
+    MultiFab b(ba, dm, ncomp, ngrow), lap_b(ba, dm, ncomp, 0);
+
+    int nfail = 0;
+
+    for (int iter = 0; iter < 8; ++iter)
+    {
+        const bool tiling = (iter % 2 == 1);
+        const bool per    = (iter % 4 >= 2);
+        const Periodicity& period = per ? geom.periodicity() : Periodicity::NonPeriodic();
+
+        SetValid(a, iter);
+        SetValid(b, iter);
+
+        a.FillBoundary_nowait(period);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            MFItInfo info;
+            if (tiling) info.EnableTiling(IntVect(AMREX_D_DECL(1024,4,4)));
+            info.SetOverlapFillBoundary(a, ngrow);
+            for (MFIter mfi(lap_a, info); mfi.isValid(); ++mfi) {
+                Laplacian(a[mfi], lap_a[mfi], mfi.tilebox(), ncomp);
+            }
+        }
+        a.FillBoundary_finish();
+
+        b.FillBoundary(period);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(lap_b, tiling); mfi.isValid(); ++mfi) {
+            Laplacian(b[mfi], lap_b[mfi], mfi.tilebox(), ncomp);
+        }
+
+        const Real diff_lap   = MaxDiff(lap_a, lap_b);
+        const Real diff_ghost = MaxDiff(a, b);
+        if (diff_lap != 0.0 || diff_ghost != 0.0) ++nfail;
+
+        amrex::Print() << "iter " << iter << " tiling " << tiling << " periodic " << per
+                       << " max diff " << diff_lap << " in the Laplacian, "
+                       << diff_ghost << " in the ghost cells\n";
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,216 @@
+//
+// A test of DistributionMapping::makeRemap.
+//
+//   mpirun -np 8 tRemap.ex
+//
+// Grids covering a ball are replaced by grids, not aligned with them,
+// covering a moved ball, and mapped with makeRemap, by cells and by a cost
+// per box, with several tolerances.  No process may get more than
+// (1+tolerance) times the average load, or the average and a box when the
+// tolerance is smaller than a box.  Every box that does not go to the
+// process owning most of its old data must be one that process had no
+// room for.  The remap must keep at least as much data in place as a fresh
+// SFC map, and remapping unchanged grids that are balanced must give the
+// old map.
+//
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include <AMReX.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+//
+// The blocks of the domain, of size blk, whose centers are within radius
+// of center.
+//
+static
+BoxArray
+Ball (const Box& domain, int blk, const IntVect& center, Real radius)
+{
+    BoxList bl;
+    BoxArray blocks(domain);
+    blocks.maxSize(blk);
+    for (int i = 0; i < blocks.size(); ++i) {
+        const Box& b = blocks[i];
+        Real r2 = 0.0;
+        for (int d = 0; d < BL_SPACEDIM; ++d) {
+            const Real x = 0.5*(b.smallEnd(d) + b.bigEnd(d) + 1) - center[d];
+            r2 += x*x;
+        }
+        if (r2 <= radius*radius) bl.push_back(b);
+    }
+    return BoxArray(bl);
+}
+
+//
+// For each box, the number of its cells each process owns in old_ba.
+//
+static
+Array<std::map<int,long> >
+Overlaps (const BoxArray& ba, const BoxArray& old_ba, const DistributionMapping& old_dm)
+{
+    Array<std::map<int,long> > ov(ba.size());
+    std::vector< std::pair<int,Box> > isects;
+    for (int i = 0; i < ba.size(); ++i) {
+        old_ba.intersections(ba[i], isects);
+        for (const auto& is : isects) {
+            ov[i][old_dm[is.first]] += is.second.numPts();
+        }
+    }
+    return ov;
+}
+
+static
+long
+Kept (const Array<std::map<int,long> >& ov, const DistributionMapping& dm)
+{
+    long kept = 0;
+    for (int i = 0; i < ov.size(); ++i) {
+        auto it = ov[i].find(dm[i]);
+        if (it != ov[i].end()) kept += it->second;
+    }
+    return kept;
+}
+
+//
+// Checks dm, the remap of ba with the weights wgts, against the rules.
+// Returns the number of failures.
+//
+static
+int
+Check (const char* name, const BoxArray& ba, const Array<long>& wgts, const DistributionMapping& dm,
+       const BoxArray& old_ba, const DistributionMapping& old_dm, Real tolerance)
+{
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int N = ba.size();
+
+    long total = 0, wmax = 0;
+    Array<long> load(nprocs, 0);
+    for (int i = 0; i < N; ++i) {
+        total += wgts[i];
+        wmax = std::max(wmax, wgts[i]);
+        load[dm[i]] += wgts[i];
+    }
+    const long cap  = std::max(static_cast<long>(std::ceil((1.0+tolerance)*Real(total)/nprocs)), wmax);
+    const long lmax = *std::max_element(load.begin(), load.end());
+
+    const Array<std::map<int,long> > ov = Overlaps(ba, old_ba, old_dm);
+
+    //
+    // A box goes elsewhere than to the process with the largest overlap
+    // only if that process is full.
+    //
+    int nmoved = 0;
+    for (int i = 0; i < N; ++i) {
+        long best = 0;
+        int  bestp = -1;
+        for (const auto& kv : ov[i]) {
+            if (kv.second > best) { best = kv.second; bestp = kv.first; }
+        }
+        auto it = ov[i].find(dm[i]);
+        const long mine = (it == ov[i].end()) ? 0 : it->second;
+        if (bestp >= 0 && mine < best && load[bestp] + wgts[i] <= cap) ++nmoved;
+    }
+
+    DistributionMapping sfc = DistributionMapping::makeSFC(Array<Real>(wgts.begin(), wgts.end()), ba);
+    const long kept     = Kept(ov, dm);
+    const long kept_sfc = Kept(ov, sfc);
+
+    amrex::Print() << name << ", tolerance " << tolerance << ": " << N << " boxes, efficiency "
+                   << Real(total)/(Real(nprocs)*lmax) << ", " << kept << " cells kept in place ("
+                   << kept_sfc << " with SFC), " << nmoved << " boxes moved needlessly\n";
+
+    int nfail = 0;
+    //
+    // The boxes that cannot stay go to the least loaded processes, which
+    // may take one box more than the tolerance allows when the tolerance
+    // is smaller than a box.
+    //
+    const long bound = std::max(cap, (total + nprocs - 1)/nprocs + wmax);
+    if (lmax > bound) {
+        amrex::Print() << "    load " << lmax << " above " << bound << "\n";
+        ++nfail;
+    }
+    if (nmoved != 0 || kept < kept_sfc) ++nfail;
+    return nfail;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(127,127,127)));
+    const IntVect c0(AMREX_D_DECL(60,64,62));
+    const IntVect c1(AMREX_D_DECL(84,68,62));
+
+    //
+    // The new blocks are not aligned with the old ones, so most new boxes
+    // overlap several processes, and the processes on the side the ball
+    // moves to cannot keep all their data.
+    //
+    const BoxArray old_ba = Ball(domain, 8, c0, 40.0);
+    const BoxArray new_ba = Ball(Box(domain).shift(IntVect(AMREX_D_DECL(4,4,4))), 8, c1, 36.0);
+    const DistributionMapping old_dm(old_ba, nprocs);
+
+    int nfail = 0;
+
+    for (Real tolerance : {0.02, 0.1, 0.5})
+    {
+        Array<long> cells(new_ba.size());
+        for (int i = 0; i < new_ba.size(); ++i) cells[i] = new_ba[i].numPts();
+        DistributionMapping dm = DistributionMapping::makeRemap(new_ba, old_ba, old_dm, tolerance);
+        nfail += Check("cells", new_ba, cells, dm, old_ba, old_dm, tolerance);
+
+        //
+        // Boxes near the new center cost more.  The costs are scaled the
+        // way makeRemap scales them.
+        //
+        Array<Real> rcost(new_ba.size());
+        Array<long> wgts(new_ba.size());
+        for (int i = 0; i < new_ba.size(); ++i) {
+            Real r2 = 0.0;
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                const Real x = new_ba[i].smallEnd(d) + 4 - c1[d];
+                r2 += x*x;
+            }
+            rcost[i] = 1.0 + 3.0*std::exp(-r2/400.0);
+        }
+        const Real rmax = *std::max_element(rcost.begin(), rcost.end());
+        for (int i = 0; i < new_ba.size(); ++i) {
+            wgts[i] = static_cast<long>(rcost[i] * (1.e9/rmax)) + 1;
+        }
+        dm = DistributionMapping::makeRemap(rcost, new_ba, old_ba, old_dm, tolerance);
+        nfail += Check("cost ", new_ba, wgts, dm, old_ba, old_dm, tolerance);
+    }
+
+    //
+    // Unchanged grids that are balanced within the tolerance stay where
+    // they are.
+    //
+    {
+        BoxArray ba(domain);
+        ba.maxSize(16);
+        Array<int> pmap(ba.size());
+        for (int i = 0; i < ba.size(); ++i) pmap[i] = (7*i + 3) % nprocs;
+        const DistributionMapping rr(pmap);
+        const DistributionMapping dm = DistributionMapping::makeRemap(ba, ba, rr, 0.1);
+        const bool same = (dm.ProcessorMap() == rr.ProcessorMap());
+        amrex::Print() << "unchanged grids: " << (same ? "same map" : "DIFFERENT map") << "\n";
+        if (!same) ++nfail;
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
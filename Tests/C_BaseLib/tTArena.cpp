@@ -0,0 +1,197 @@
+//
+// A test of TArena.
+//
+//   OMP_NUM_THREADS=4 tTArena.ex [nblocks=20000]
+//
+// Blocks of random sizes, small and large, are allocated and freed by
+// all the threads, most of them by another thread than the one that
+// allocated them, and every block must keep its contents.  Power-of-two
+// requests must not take much more heap than their size.  Finally
+// MultiFabs are built with amrex.fab_arena=TArena and
+// fabarray.first_touch=1, which are turned on here, and their data
+// must be right.
+//
+
+#include <iostream>
+#include <vector>
+
+#include <AMReX.H>
+#include <AMReX_TArena.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+static
+void
+AddParameters ()
+{
+    ParmParse pp("amrex");
+    pp.add("fab_arena", std::string("TArena"));
+    ParmParse ppfa("fabarray");
+    ppfa.add("first_touch", 1);
+}
+
+struct Block
+{
+    long*       p;
+    std::size_t n;
+};
+
+static
+void
+Fill (const Block& b, long tag)
+{
+    for (std::size_t i = 0; i < b.n; ++i) b.p[i] = tag + i;
+}
+
+static
+bool
+Check (const Block& b, long tag)
+{
+    for (std::size_t i = 0; i < b.n; ++i) {
+        if (b.p[i] != long(tag + i)) return false;
+    }
+    return true;
+}
+
+//
+// Returns the number of blocks that lost their contents.
+//
+static
+int
+TestAllocFree (TArena& arena, int nblocks)
+{
+    //
+    // Sizes of up to twice the largest size class, with powers of two and
+    // zero among them.
+    //
+    std::vector<std::size_t> sizes(nblocks);
+    for (int i = 0; i < nblocks; ++i) {
+        const int k = amrex::Random_int(22);
+        sizes[i] = (i % 3 == 0) ? (std::size_t(1) << k) : amrex::Random_int(std::size_t(1) << k);
+        if (i % 101 == 0) sizes[i] = 0;
+    }
+
+    std::vector<Block> blocks(nblocks);
+    int nbad = 0;
+
+    for (int pass = 0; pass < 3; ++pass)
+    {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,7)
+#endif
+        for (int i = 0; i < nblocks; ++i) {
+            const std::size_t n = sizes[(i + pass) % nblocks] / sizeof(long);
+            blocks[i].p = static_cast<long*>(arena.alloc(n*sizeof(long)));
+            blocks[i].n = n;
+            Fill(blocks[i], 1000000L*i + pass);
+        }
+        //
+        // The blocks are checked and freed by another thread than the one
+        // that allocated them, if there is one.
+        //
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,5) reduction(+:nbad)
+#endif
+        for (int i = 0; i < nblocks; ++i) {
+            const int j = (i + nblocks/2) % nblocks;
+            if (!Check(blocks[j], 1000000L*j + pass)) ++nbad;
+        }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static,5)
+#endif
+        for (int i = 0; i < nblocks; ++i) {
+            const int j = (i + nblocks/2) % nblocks;
+            arena.free(blocks[j].p);
+        }
+    }
+
+    return nbad;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv,true,MPI_COMM_WORLD,AddParameters);
+
+    int nblocks = 20000;
+    {
+        ParmParse pp;
+        pp.query("nblocks", nblocks);
+    }
+
+    int nfail = 0;
+
+    {
+        TArena arena;
+        const int nbad = TestAllocFree(arena, nblocks);
+        amrex::Print() << "alloc and free: " << nbad << " blocks lost their contents\n";
+        if (nbad != 0) ++nfail;
+    }
+    //
+    // Power-of-two requests from a single thread, with small hunks so that
+    // little is left over.
+    //
+    for (std::size_t sz = 1024; sz <= 65536; sz *= 4)
+    {
+        const std::size_t hunk = 1024*1024;
+        TArena arena(0, hunk);
+        const int n = 256;
+        std::vector<void*> p(n);
+        for (int i = 0; i < n; ++i) {
+            p[i] = arena.alloc(sz);
+        }
+        const double ratio = double(arena.heap_space_used()) / double(n*sz + hunk);
+        amrex::Print() << "heap space for " << n << " blocks of " << sz
+                       << " bytes, relative to their size plus a hunk: " << ratio << "\n";
+        if (ratio > 1.1) ++nfail;
+        for (int i = 0; i < n; ++i) {
+            arena.free(p[i]);
+        }
+    }
+    //
+    // MultiFabs in the TArena, touched first by the threads that own them.
+    //
+    {
+        Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(63,63,63)));
+        BoxArray ba(domain);
+        ba.maxSize(16);
+        DistributionMapping dm(ba);
+
+        // The ghost cells between grids are counted once per grid.
+        Real npts = 0.0;
+        for (int i = 0; i < ba.size(); ++i) {
+            npts += amrex::grow(ba[i],1).numPts();
+        }
+
+        Real err = 0.0;
+        for (int iter = 0; iter < 4; ++iter)
+        {
+            MultiFab mf(ba, dm, 2, 1);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            for (MFIter mfi(mf,true); mfi.isValid(); ++mfi) {
+                mf[mfi].setVal(iter + 1.0, mfi.growntilebox(), 0, 2);
+            }
+            for (int n = 0; n < 2; ++n) {
+                Real sum = 0.0;
+                for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+                    sum += mf[mfi].sum(n);
+                }
+                ParallelDescriptor::ReduceRealSum(sum);
+                err = std::max(err, std::abs(sum - (iter + 1.0)*npts));
+            }
+        }
+        amrex::Print() << "MultiFabs with first touch: max error " << err << "\n";
+        if (err != 0.0) ++nfail;
+    }
+
+    ParallelDescriptor::ReduceIntMax(nfail);
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,113 @@
+//
+// A test of plotfiles written with VisMF::AsyncWrite.
+//
+//   mpirun -np 4 tVisMFAsync.ex [vismf.asyncwrite=1] [nrep=4]
+//
+// Asynchronous writes are turned on unless vismf.asyncwrite=0 is given.
+// A plotfile is written to a temporary name and renamed once
+// VisMF::AsyncWait has returned on all processes, like Amr does.  It is
+// then read back and compared with the data, several times in a row so
+// that a write is still in flight when the next one starts.
+//
+
+#include <iostream>
+#include <cstdio>
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+#include <AMReX_ParallelDescriptor.H>
+
+using namespace amrex;
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int nrep = 4;
+    {
+        ParmParse pp;
+        pp.query("nrep", nrep);
+
+        ParmParse ppv("vismf");
+        if (!ppv.contains("asyncwrite")) {
+            VisMF::SetAsyncWrite(true);
+        }
+    }
+
+    Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(63,63,63)));
+    BoxArray ba(domain);
+    ba.maxSize(16);
+    DistributionMapping dm(ba);
+
+    RealBox rb(AMREX_D_DECL(0.0,0.0,0.0), AMREX_D_DECL(1.0,1.0,1.0));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(0,0,0)};
+    Geometry geom(domain, &rb, 0, is_per);
+
+    const int ncomp = 2;
+    MultiFab mf(ba, dm, ncomp, 0);
+
+    Array<std::string> varnames;
+    for (int n = 0; n < ncomp; ++n) {
+        varnames.push_back(amrex::Concatenate("var", n, 1));
+    }
+
+    int nfail = 0;
+
+    for (int irep = 0; irep < nrep; ++irep)
+    {
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            for (int n = 0; n < ncomp; ++n) {
+                for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                    mf[mfi](iv,n) = AMREX_D_TERM(iv[0], + 100.0*iv[1], + 1.e4*iv[2])
+                        + 0.5*n + 1.e-3*irep;
+                }
+            }
+        }
+
+        const std::string pltfile = amrex::Concatenate("pltasync", irep, 5);
+        const std::string pltfileTemp = pltfile + ".temp";
+
+        if (ParallelDescriptor::IOProcessor()) {
+            if (amrex::FileExists(pltfile)) {
+                amrex::UtilRenameDirectoryToOld(pltfile, false);
+            }
+        }
+
+        amrex::WriteSingleLevelPlotfile(pltfileTemp, mf, varnames, geom, 0.0, irep);
+
+        VisMF::AsyncWait();
+        ParallelDescriptor::Barrier();
+
+        if (ParallelDescriptor::IOProcessor()) {
+            std::rename(pltfileTemp.c_str(), pltfile.c_str());
+        }
+        ParallelDescriptor::Barrier();
+
+        MultiFab mfin;
+        VisMF::Read(mfin, pltfile + "/Level_0/Cell");
+
+        MultiFab diff(ba, dm, ncomp, 0);
+        diff.copy(mfin);
+        MultiFab::Subtract(diff, mf, 0, 0, ncomp, 0);
+        Real err = 0.0;
+        for (int n = 0; n < ncomp; ++n) {
+            err = std::max(err, diff.norm0(n));
+        }
+
+        if (err != 0.0 || mfin.boxArray() != ba) ++nfail;
+
+        amrex::Print() << pltfile << " max diff " << err << "\n";
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,149 @@
+//
+// A test of VisMF::mapFAB.
+//
+//   mpirun -np 4 tVisMFMap.ex
+//
+// A MultiFab with ghost cells is written, and every fab, with all its
+// components and with each one, is mapped and compared with readFAB.
+// The MultiFab is then rewritten under the same name, with more
+// components and then with as many as at first, while the fabs mapped
+// from the first file are still alive.  The fabs mapped from the new
+// files must be the new data.  Once the VisMFs are gone, no data file
+// may be left mapped (checked where /proc/self/maps is there).
+//
+
+#include <iostream>
+#include <fstream>
+#include <memory>
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_Utility.H>
+#include <AMReX_ParallelDescriptor.H>
+
+using namespace amrex;
+
+static const std::string mfName("mfmap");
+
+static
+void
+WriteMF (const BoxArray& ba, const DistributionMapping& dm, int ncomp, int version)
+{
+    MultiFab mf(ba, dm, ncomp, 1);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox& fab = mf[mfi];
+        const Box& bx = fab.box();
+        for (int n = 0; n < ncomp; ++n) {
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                fab(iv,n) = AMREX_D_TERM(iv[0], + 100.0*iv[1], + 1.e4*iv[2]) + 0.5*n + 1.e-3*version;
+            }
+        }
+    }
+    VisMF::Write(mf, mfName);
+    ParallelDescriptor::Barrier();
+}
+
+static
+Real
+MaxDiff (const FArrayBox& a, const FArrayBox& b)
+{
+    if (a.box() != b.box() || a.nComp() != b.nComp()) return 1.e30;
+    FArrayBox d(a.box(), a.nComp());
+    d.copy(a);
+    d.minus(b);
+    return d.norm(0, 0, a.nComp());
+}
+
+//
+// Map the fabs of this process, all components and each one, and compare
+// them with readFAB and with the value of the version written.  The fabs
+// mapped with all their components are kept in mapped.
+//
+static
+Real
+CheckMapped (VisMF& vismf, int version, Array<std::unique_ptr<FArrayBox> >& mapped)
+{
+    Real r = 0.0;
+    const int ncomp = vismf.nComp();
+    for (int i = 0; i < vismf.size(); ++i)
+    {
+        if (i % ParallelDescriptor::NProcs() != ParallelDescriptor::MyProc()) continue;
+
+        std::unique_ptr<FArrayBox> all(vismf.mapFAB(i));
+        std::unique_ptr<FArrayBox> ref(vismf.readFAB(i, -1));
+        r = std::max(r, MaxDiff(*all, *ref));
+
+        const IntVect& iv = all->smallEnd();
+        const Real v = AMREX_D_TERM(iv[0], + 100.0*iv[1], + 1.e4*iv[2]) + 1.e-3*version;
+        for (int n = 0; n < ncomp; ++n) {
+            r = std::max(r, std::abs((*all)(iv,n) - (v + 0.5*n)));
+
+            std::unique_ptr<FArrayBox> one(vismf.mapFAB(i, n));
+            std::unique_ptr<FArrayBox> ref1(vismf.readFAB(i, n));
+            r = std::max(r, MaxDiff(*one, *ref1));
+        }
+        mapped.push_back(std::move(all));
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+//
+// The number of mappings of our data files, or 0 if it cannot be told.
+//
+static
+int
+NumMapped ()
+{
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    int n = 0;
+    while (std::getline(maps, line)) {
+        if (line.find(mfName + "_D_") != std::string::npos) ++n;
+    }
+    ParallelDescriptor::ReduceIntMax(n);
+    return n;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(31,31,31)));
+    BoxArray ba(domain);
+    ba.maxSize(8);
+    DistributionMapping dm(ba);
+
+    int nfail = 0;
+    {
+        WriteMF(ba, dm, 2, 0);
+        VisMF first(mfName);
+        Array<std::unique_ptr<FArrayBox> > first_mapped;
+        Real diff = CheckMapped(first, 0, first_mapped);
+        amrex::Print() << "first file: max diff " << diff << "\n";
+        if (diff != 0.0) ++nfail;
+        //
+        // Rewritten larger, and then back to the first size.
+        //
+        for (int version = 1; version <= 2; ++version)
+        {
+            WriteMF(ba, dm, (version == 1) ? 3 : 2, version);
+            VisMF rewritten(mfName);
+            Array<std::unique_ptr<FArrayBox> > mapped;
+            diff = CheckMapped(rewritten, version, mapped);
+            amrex::Print() << "rewritten file " << version << ": max diff " << diff << "\n";
+            if (diff != 0.0) ++nfail;
+        }
+    }
+
+    const int nmapped = NumMapped();
+    amrex::Print() << "mappings left: " << nmapped << "\n";
+    if (nmapped != 0) ++nfail;
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,134 @@
+//
+// A test of VisMF::ReadRegion.
+//
+//   mpirun -np 4 tVisMFRegion.ex
+//
+// A MultiFab with ghost cells is written with each header version.
+// Several regions, inside one grid, across grids, sticking out of the
+// domain and outside it, are read with some of the components, in
+// order and not.  The data read must be those of a full VisMF::Read
+// restricted to the region and the components.
+//
+
+#include <iostream>
+
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_VisMF.H>
+#include <AMReX_ParallelDescriptor.H>
+
+using namespace amrex;
+
+static
+Real
+MaxDiff (const MultiFab& a, const MultiFab& b)
+{
+    Real r = 0.0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        FArrayBox d(a[mfi].box(), a.nComp());
+        d.copy(a[mfi]);
+        d.minus(b[mfi]);
+        r = std::max(r, d.norm(0,0,a.nComp()));
+    }
+    ParallelDescriptor::ReduceRealMax(r);
+    return r;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(47,47,47)));
+    BoxArray ba(domain);
+    ba.maxSize(16);
+    DistributionMapping dm(ba);
+
+    const int ncomp = 4;
+    MultiFab mf(ba, dm, ncomp, 1);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        FArrayBox& fab = mf[mfi];
+        const Box& bx = fab.box();
+        for (int n = 0; n < ncomp; ++n) {
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                fab(iv,n) = AMREX_D_TERM(std::sin(0.3*iv[0]), + 100.0*iv[1], + 1.e4*iv[2]) + 0.5*n;
+            }
+        }
+    }
+
+    Array<Box> regions;
+    regions.push_back(Box(IntVect(AMREX_D_DECL(2,3,4)), IntVect(AMREX_D_DECL(9,12,7))));
+    regions.push_back(Box(IntVect(AMREX_D_DECL(5,10,14)), IntVect(AMREX_D_DECL(40,20,33))));
+    regions.push_back(Box(IntVect(AMREX_D_DECL(-3,30,-5)), IntVect(AMREX_D_DECL(20,60,3))));
+    regions.push_back(domain);
+    regions.push_back(Box(IntVect(AMREX_D_DECL(60,0,0)), IntVect(AMREX_D_DECL(70,5,5))));
+
+    Array<Array<int> > comps(3);
+    comps[0] = {2};
+    comps[1] = {0, 3};
+    comps[2] = {3, 1, 0};
+
+    const VisMF::Header::Version versions[] = { VisMF::Header::Version_v1,
+                                                VisMF::Header::NoFabHeader_v1,
+                                                VisMF::Header::Compressed_v1 };
+
+    int nfail = 0;
+
+    for (auto version : versions)
+    {
+        const VisMF::Header::Version old_version = VisMF::GetHeaderVersion();
+        VisMF::SetHeaderVersion(version);
+        VisMF::Write(mf, "mfregion");
+        VisMF::SetHeaderVersion(old_version);
+        ParallelDescriptor::Barrier();
+
+        MultiFab full;
+        VisMF::Read(full, "mfregion");
+
+        VisMF vismf("mfregion");
+
+        for (const Box& region : regions)
+        {
+            for (const Array<int>& c : comps)
+            {
+                MultiFab part;
+                vismf.ReadRegion(part, region, c);
+
+                const Box inside = region & domain;
+                if (!inside.ok()) {
+                    if (!part.boxArray().empty()) {
+                        amrex::Print() << "region " << region << " is outside, but something was read\n";
+                        ++nfail;
+                    }
+                    continue;
+                }
+                if (part.boxArray().numPts() != inside.numPts() || part.nComp() != int(c.size())) {
+                    amrex::Print() << "region " << region << ": wrong size\n";
+                    ++nfail;
+                    continue;
+                }
+                //
+                // The valid cells on disk do not overlap, so this picks the
+                // same data as the region read.
+                //
+                MultiFab ref(part.boxArray(), part.DistributionMap(), part.nComp(), 0);
+                for (int k = 0; k < int(c.size()); ++k) {
+                    ref.ParallelCopy(full, c[k], k, 1);
+                }
+                const Real diff = MaxDiff(part, ref);
+                if (diff != 0.0) {
+                    amrex::Print() << "version " << version << " region " << region
+                                   << " " << c.size() << " components: max diff " << diff << "\n";
+                    ++nfail;
+                }
+            }
+        }
+        amrex::Print() << "version " << version << " done\n";
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
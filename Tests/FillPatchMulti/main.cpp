@@ -0,0 +1,342 @@
+//
+// A test of the AmrLevel::FillPatch that fills several state types at once.
+//
+//   mpirun -np 4 main.ex inputs [ngrow=2]
+//
+// A hierarchy is built for two state types, the first with components
+// interpolated conservatively and piecewise constant, the second with
+// linear interpolation.  The domain is periodic in some directions and
+// not in the others, where a boundary function fills the ghost cells.
+// On every fine level both states, grown by ngrow cells, are filled twice
+// with the multi-state FillPatch, the second time with the plan it kept
+// from the first, and with amrex::FillPatchTwoLevels for each component
+// range of each state, and the results must be the same.
+//
+
+#include <iostream>
+#include <cmath>
+#include <memory>
+
+#include <AMReX.H>
+#include <AMReX_Amr.H>
+#include <AMReX_AmrLevel.H>
+#include <AMReX_LevelBld.H>
+#include <AMReX_Interpolater.H>
+#include <AMReX_FillPatchUtil.H>
+#include <AMReX_PROB_AMR_F.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+enum StateType { A_Type = 0, B_Type, NUM_STATE_TYPE };
+
+static const int NUM_A = 3;
+static const int NUM_B = 1;
+
+//
+// A smooth function of the cell center, different for each component.
+//
+static
+Real
+Value (const Real* x, int comp)
+{
+    return AMREX_D_TERM(std::sin(6.0*x[0] + comp), + std::cos(4.0*x[1] - comp), + x[2]*x[2]) + comp;
+}
+
+//
+// The values outside the non-periodic faces of the domain.
+//
+extern "C"
+void
+testfill (Real* data, const int* lo, const int* hi,
+          const int* dom_lo, const int* dom_hi, const Real* dx, const Real* grd_lo,
+          const Real* time, const int* bc)
+{
+    const long nx = hi[0] - lo[0] + 1;
+    const long ny = hi[1] - lo[1] + 1;
+
+    for (int k = lo[2]; k <= hi[2]; ++k) {
+        for (int j = lo[1]; j <= hi[1]; ++j) {
+            for (int i = lo[0]; i <= hi[0]; ++i) {
+                const int iv[3] = {i, j, k};
+                bool outside = false;
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    if (bc[d] == EXT_DIR && iv[d] < dom_lo[d]) outside = true;
+                    if (bc[BL_SPACEDIM+d] == EXT_DIR && iv[d] > dom_hi[d]) outside = true;
+                }
+                if (outside) {
+                    data[(i-lo[0]) + nx*((j-lo[1]) + ny*(k-lo[2]))] = 10.0 + 0.01*(i + 2*j + 3*k);
+                }
+            }
+        }
+    }
+}
+
+extern "C"
+void
+amrex_probinit (const int* init, const int* name, const int* namelen,
+                const amrex_real* problo, const amrex_real* probhi)
+{}
+
+class TestLevel
+    : public AmrLevel
+{
+public:
+
+    TestLevel () {}
+
+    TestLevel (Amr& papa, int lev, const Geometry& level_geom, const BoxArray& bl,
+               const DistributionMapping& dm, Real time)
+        : AmrLevel(papa, lev, level_geom, bl, dm, time) {}
+
+    static void variableSetUp ();
+
+    static void variableCleanUp () { desc_lst.clear(); }
+
+    virtual void computeInitialDt (int finest_level, int sub_cycle, Array<int>& n_cycle,
+                                   const Array<IntVect>& ref_ratio, Array<Real>& dt_level,
+                                   Real stop_time) override
+    {
+        for (int i = 0; i <= finest_level; ++i) {
+            dt_level[i] = 0.01 / parent->Geom(i).Domain().length(0);
+        }
+    }
+
+    virtual void computeNewDt (int finest_level, int sub_cycle, Array<int>& n_cycle,
+                               const Array<IntVect>& ref_ratio, Array<Real>& dt_min,
+                               Array<Real>& dt_level, Real stop_time,
+                               int post_regrid_flag) override {}
+
+    virtual Real advance (Real time, Real dt, int iteration, int ncycle) override { return dt; }
+
+    virtual void post_timestep (int iteration) override {}
+
+    virtual void post_regrid (int lbase, int new_finest) override {}
+
+    virtual void post_init (Real stop_time) override {}
+
+    virtual void initData () override
+    {
+        const Real* dx = geom.CellSize();
+        for (int idx = 0; idx < NUM_STATE_TYPE; ++idx)
+        {
+            MultiFab& S_new = get_new_data(idx);
+            for (MFIter mfi(S_new); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.validbox();
+                FArrayBox& fab = S_new[mfi];
+                for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                    Real x[BL_SPACEDIM];
+                    for (int d = 0; d < BL_SPACEDIM; ++d) {
+                        x[d] = geom.ProbLo(d) + (iv[d] + 0.5) * dx[d];
+                    }
+                    for (int n = 0; n < S_new.nComp(); ++n) {
+                        fab(iv,n) = Value(x, n + NUM_A*idx);
+                    }
+                }
+            }
+        }
+    }
+
+    virtual void init (AmrLevel& old) override
+    {
+        const Real cur_time = old.get_state_data(A_Type).curTime();
+        setTimeLevel(cur_time, 0.0, parent->dtLevel(level));
+
+        Array<MultiFab*> S_new(NUM_STATE_TYPE);
+        Array<int>       index(NUM_STATE_TYPE);
+        for (int idx = 0; idx < NUM_STATE_TYPE; ++idx) {
+            S_new[idx] = &get_new_data(idx);
+            index[idx] = idx;
+        }
+        FillPatch(old, S_new, 0, cur_time, index);
+    }
+
+    virtual void init () override
+    {
+        const Real cur_time = parent->getLevel(level-1).get_state_data(A_Type).curTime();
+        setTimeLevel(cur_time, 0.0, parent->dtLevel(level));
+
+        for (int idx = 0; idx < NUM_STATE_TYPE; ++idx) {
+            MultiFab& S_new = get_new_data(idx);
+            FillCoarsePatch(S_new, 0, cur_time, idx, 0, S_new.nComp());
+        }
+    }
+    //
+    // Tag a spherical shell and a slab touching the non-periodic faces.
+    //
+    virtual void errorEst (TagBoxArray& tags, int clearval, int tagval, Real time,
+                           int n_error_buf, int ngrow) override
+    {
+        const Real* dx = geom.CellSize();
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            TagBox& tagfab = tags[mfi];
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                Real r2 = 0.0;
+                Real x[BL_SPACEDIM];
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    x[d] = geom.ProbLo(d) + (iv[d] + 0.5) * dx[d];
+                    r2 += (x[d] - 0.5) * (x[d] - 0.5);
+                }
+                const bool shell = std::abs(std::sqrt(r2) - 0.3) < 2.0*dx[0];
+                const bool slab  = std::abs(x[0] - 0.8) < 0.06;
+                if (shell || slab) {
+                    tagfab(iv) = tagval;
+                }
+            }
+        }
+    }
+};
+
+void
+TestLevel::variableSetUp ()
+{
+    BL_ASSERT(desc_lst.size() == 0);
+
+    int lo_bc[BL_SPACEDIM];
+    int hi_bc[BL_SPACEDIM];
+    for (int d = 0; d < BL_SPACEDIM; ++d) {
+        lo_bc[d] = hi_bc[d] = Geometry::isPeriodic(d) ? INT_DIR : EXT_DIR;
+    }
+    BCRec bc(lo_bc, hi_bc);
+
+    desc_lst.addDescriptor(A_Type, IndexType::TheCellType(), StateDescriptor::Point,
+                           0, NUM_A, &cell_cons_interp);
+    desc_lst.setComponent(A_Type, 0, "a0", bc, StateDescriptor::BndryFunc(testfill));
+    desc_lst.setComponent(A_Type, 1, "a1", bc, StateDescriptor::BndryFunc(testfill));
+    desc_lst.setComponent(A_Type, 2, "a2", bc, StateDescriptor::BndryFunc(testfill), &pc_interp);
+
+    desc_lst.addDescriptor(B_Type, IndexType::TheCellType(), StateDescriptor::Point,
+                           0, NUM_B, &lincc_interp);
+    desc_lst.setComponent(B_Type, 0, "b0", bc, StateDescriptor::BndryFunc(testfill));
+}
+
+class TestLevelBld
+    : public LevelBld
+{
+    virtual void variableSetUp () override { TestLevel::variableSetUp(); }
+
+    virtual void variableCleanUp () override { TestLevel::variableCleanUp(); }
+
+    virtual AmrLevel* operator() () override { return new TestLevel; }
+
+    virtual AmrLevel* operator() (Amr& papa, int lev, const Geometry& level_geom,
+                                  const BoxArray& ba, const DistributionMapping& dm,
+                                  Real time) override
+    {
+        return new TestLevel(papa, lev, level_geom, ba, dm, time);
+    }
+};
+
+TestLevelBld test_bld;
+
+//
+// Fill state idx of level lev of amr into mf, with its ghost cells, the
+// way it was done before there were plans: FillPatchTwoLevels for each
+// range of components that share an interpolater.
+//
+static
+void
+FillReference (Amr& amr, int lev, MultiFab& mf, Real time, int idx)
+{
+    AmrLevel& fine = amr.getLevel(lev);
+    AmrLevel& crse = amr.getLevel(lev-1);
+    StateData& sd_fine = fine.get_state_data(idx);
+    StateData& sd_crse = crse.get_state_data(idx);
+    const StateDescriptor& desc = AmrLevel::get_desc_lst()[idx];
+
+    Array<MultiFab*> fmf, cmf;
+    Array<Real>      ft, ct;
+    sd_fine.getData(fmf, ft, time);
+    sd_crse.getData(cmf, ct, time);
+
+    const std::vector< std::pair<int,int> >& range = desc.sameInterps(0, desc.nComp());
+    for (int k = 0; k < range.size(); ++k)
+    {
+        const int scomp = range[k].first;
+        const int ncomp = range[k].second;
+        StateDataPhysBCFunct cbc(sd_crse, scomp, crse.Geom());
+        StateDataPhysBCFunct fbc(sd_fine, scomp, fine.Geom());
+        amrex::FillPatchTwoLevels(mf, time, cmf, ct, fmf, ft, scomp, scomp, ncomp,
+                                  crse.Geom(), fine.Geom(), cbc, fbc, amr.refRatio(lev-1),
+                                  desc.interp(scomp), desc.getBCs());
+    }
+}
+
+LevelBld*
+getLevelBld ()
+{
+    return &test_bld;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int ngrow = 2;
+    {
+        ParmParse pp;
+        pp.query("ngrow", ngrow);
+    }
+
+    int nfail = 0;
+    {
+        Amr amr;
+        amr.init(0.0, 1.0);
+
+        const Real time = amr.cumTime();
+
+        for (int lev = 1; lev <= amr.finestLevel(); ++lev)
+        {
+            AmrLevel& amrlevel = amr.getLevel(lev);
+
+            Array<std::unique_ptr<MultiFab> > together(NUM_STATE_TYPE), ref(NUM_STATE_TYPE);
+            Array<MultiFab*> leveldata(NUM_STATE_TYPE);
+            Array<int>       index(NUM_STATE_TYPE);
+
+            for (int idx = 0; idx < NUM_STATE_TYPE; ++idx)
+            {
+                const MultiFab& S = amrlevel.get_new_data(idx);
+                together[idx].reset(new MultiFab(S.boxArray(), S.DistributionMap(), S.nComp(), ngrow));
+                ref[idx].reset(new MultiFab(S.boxArray(), S.DistributionMap(), S.nComp(), ngrow));
+                ref[idx]->setVal(-2.0);
+                leveldata[idx] = together[idx].get();
+                index[idx] = idx;
+
+                FillReference(amr, lev, *ref[idx], time, idx);
+            }
+
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                for (int idx = 0; idx < NUM_STATE_TYPE; ++idx) {
+                    together[idx]->setVal(-1.0);
+                }
+
+                AmrLevel::FillPatch(amrlevel, leveldata, ngrow, time, index);
+
+                for (int idx = 0; idx < NUM_STATE_TYPE; ++idx)
+                {
+                    MultiFab diff(together[idx]->boxArray(), together[idx]->DistributionMap(),
+                                  together[idx]->nComp(), ngrow);
+                    MultiFab::Copy(diff, *ref[idx], 0, 0, diff.nComp(), ngrow);
+                    MultiFab::Subtract(diff, *together[idx], 0, 0, diff.nComp(), ngrow);
+                    Real maxdiff = 0.0;
+                    for (int n = 0; n < diff.nComp(); ++n) {
+                        maxdiff = std::max(maxdiff, diff.norm0(n, ngrow));
+                    }
+                    amrex::Print() << "level " << lev << " state " << idx << " pass " << pass << ": "
+                                   << amrlevel.boxArray().size() << " grids, max diff " << maxdiff << "\n";
+                    if (maxdiff != 0.0) ++nfail;
+                }
+            }
+        }
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,195 @@
+//
+// Benchmark of the C++ interpolation kernels against the Fortran ones.
+//
+//   main.ex [n_cell=128] [max_grid_size=32] [ncomp=4] [nrep=10] [ngrow=2] [tol=1.e-13]
+//
+// For refinement ratios 2 and 4, the fine domain of n_cell^SPACEDIM cells
+// is chopped into grids of max_grid_size, grown by ngrow cells.  Every
+// grid is filled from random coarse data with PCInterp and with both
+// kinds of CellConservativeLinear, nrep times with the Fortran kernels
+// and nrep times with the C++ ones.  The data next to the domain boundary
+// are taken to be given (EXT_DIR), so the one-sided slopes are done too.
+// The times and the largest difference of the results, relative to the
+// largest fine value, are printed.  The run fails, with a nonzero exit
+// status, if any relative difference is above tol.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <AMReX.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_FArrayBox.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_BCRec.H>
+#include <AMReX_BC_TYPES.H>
+#include <AMReX_Interpolater.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+static
+Real
+run (Interpolater& mapper, bool native, int nrep,
+     const Array<FArrayBox*>& crse, const Array<FArrayBox*>& fine,
+     const Array<Box>& regions, const Array<Array<BCRec> >& bcrs,
+     int ncomp, const IntVect& ratio,
+     const Geometry& cgeom, const Geometry& fgeom)
+{
+    Interpolater::SetNativeKernels(native);
+
+    ParallelDescriptor::Barrier();
+    const Real strt = ParallelDescriptor::second();
+
+    for (int r = 0; r < nrep; ++r)
+    {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < fine.size(); ++i)
+        {
+            Array<BCRec> bcr(bcrs[i]);
+            mapper.interp(*crse[i], 0, *fine[i], 0, ncomp, regions[i], ratio,
+                          cgeom, fgeom, bcr, 0, 0);
+        }
+    }
+
+    Real t = ParallelDescriptor::second() - strt;
+    ParallelDescriptor::ReduceRealMax(t);
+    return t;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell        = 128;
+    int max_grid_size = 32;
+    int ncomp         = 4;
+    int nrep          = 10;
+    int ngrow         = 2;
+    Real tol          = 1.e-13;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("ncomp", ncomp);
+        pp.query("nrep", nrep);
+        pp.query("ngrow", ngrow);
+        pp.query("tol", tol);
+    }
+
+    Interpolater::Initialize();
+    const bool native_default = Interpolater::NativeKernels();
+
+    const int ratios[] = {2, 4};
+
+    int nfail = 0;
+
+    for (int ir = 0; ir < 2; ++ir)
+    {
+        const int     R = ratios[ir];
+        const IntVect ratio(AMREX_D_DECL(R,R,R));
+
+        const Box fdomain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+        const Box cdomain = amrex::coarsen(fdomain,R);
+
+        RealBox rb(AMREX_D_DECL(0.0,0.0,0.0), AMREX_D_DECL(1.0,1.0,1.0));
+        int is_per[BL_SPACEDIM] = {AMREX_D_DECL(0,0,0)};
+        const Geometry fgeom(fdomain, &rb, 0, is_per);
+        const Geometry cgeom(cdomain, &rb, 0, is_per);
+
+        BoxArray ba(fdomain);
+        ba.maxSize(max_grid_size);
+        //
+        // This process does its share of the grids.
+        //
+        const int nprocs = ParallelDescriptor::NProcs();
+        const int myproc = ParallelDescriptor::MyProc();
+
+        Array<Box>           regions;
+        Array<Array<BCRec> > bcrs;
+        Array<FArrayBox*>    crse, fine_f, fine_n;
+
+        for (int i = myproc; i < ba.size(); i += nprocs)
+        {
+            const Box& fbx = amrex::grow(ba[i],ngrow);
+
+            BCRec bc;
+            for (int d = 0; d < BL_SPACEDIM; ++d)
+            {
+                bc.setLo(d, fbx.smallEnd(d) < fdomain.smallEnd(d) + ngrow ? EXT_DIR : INT_DIR);
+                bc.setHi(d, fbx.bigEnd(d)   > fdomain.bigEnd(d)   - ngrow ? EXT_DIR : INT_DIR);
+            }
+
+            regions.push_back(fbx);
+            bcrs.push_back(Array<BCRec>(ncomp,bc));
+
+            const Box& cbx = lincc_interp.CoarseBox(fbx,R);
+            FArrayBox* c = new FArrayBox(cbx,ncomp);
+            for (int n = 0; n < ncomp; ++n) {
+                for (IntVect iv = cbx.smallEnd(); iv <= cbx.bigEnd(); cbx.next(iv)) {
+                    Real x = AMREX_D_TERM(std::sin(0.3*iv[0]), + std::cos(0.2*iv[1]), + std::sin(0.1*iv[2]));
+                    (*c)(iv,n) = (n+1)*x + 0.1*amrex::Random();
+                }
+            }
+            crse.push_back(c);
+            fine_f.push_back(new FArrayBox(fbx,ncomp));
+            fine_n.push_back(new FArrayBox(fbx,ncomp));
+        }
+
+        Interpolater* mappers[] = {&pc_interp, &lincc_interp, &cell_cons_interp};
+        const char*   names[]   = {"PCInterp", "CellConservativeLinear(1)", "CellConservativeLinear(0)"};
+
+        for (int im = 0; im < 3; ++im)
+        {
+            Interpolater& mapper = *mappers[im];
+
+            const Real tf = run(mapper, false, nrep, crse, fine_f, regions, bcrs,
+                                ncomp, ratio, cgeom, fgeom);
+            const Real tn = run(mapper, true,  nrep, crse, fine_n, regions, bcrs,
+                                ncomp, ratio, cgeom, fgeom);
+
+            Real maxval = 0.0, maxdiff = 0.0;
+            for (int i = 0; i < fine_f.size(); ++i)
+            {
+                maxval = std::max(maxval, fine_f[i]->norm(0,0,ncomp));
+                fine_n[i]->minus(*fine_f[i]);
+                maxdiff = std::max(maxdiff, fine_n[i]->norm(0,0,ncomp));
+            }
+            ParallelDescriptor::ReduceRealMax(maxval);
+            ParallelDescriptor::ReduceRealMax(maxdiff);
+
+            const Real reldiff = maxdiff/std::max(maxval,Real(1.e-300));
+            amrex::Print() << std::setw(26) << names[im] << "  ratio " << R
+                           << "  Fortran " << std::setw(10) << tf
+                           << "  C++ " << std::setw(10) << tn
+                           << "  speedup " << std::setw(6) << tf/tn
+                           << "  rel. diff " << reldiff
+                           << (reldiff > tol ? "  ABOVE TOLERANCE" : "")
+                           << "\n";
+            if (!(reldiff <= tol)) ++nfail;
+        }
+
+        for (int i = 0; i < crse.size(); ++i) {
+            delete crse[i];
+            delete fine_f[i];
+            delete fine_n[i];
+        }
+    }
+
+    Interpolater::SetNativeKernels(native_default);
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+
+    return nfail == 0 ? 0 : 1;
+}
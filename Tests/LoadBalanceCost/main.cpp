@@ -0,0 +1,419 @@
+//
+// A test of the load balancing of Amr on measured grid costs.
+//
+//   mpirun -np 4 main.ex inputs
+//
+// Every step, the level records a cost for each grid, ten times as much
+// for the grids in one corner, and the particles of a
+// NeighborParticleContainer count too (amr.loadbalance_particle_cost).
+// With amr.loadbalance_cost_int = 1, Amr must move the grids so that the
+// busiest process has at most 1.1 times the average, and the state data
+// must come through unchanged.  The particles move with the grids, and
+// their neighbors are updated with the same communication plan across
+// the steps and the rebalancing; they must be the same as the neighbors
+// of a second container that fills them afresh every step.
+//
+
+#include <iostream>
+#include <cmath>
+#include <memory>
+
+#include <AMReX.H>
+#include <AMReX_Amr.H>
+#include <AMReX_AmrLevel.H>
+#include <AMReX_LevelBld.H>
+#include <AMReX_Interpolater.H>
+#include <AMReX_NeighborParticles.H>
+#include <AMReX_PROB_AMR_F.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+typedef NeighborParticleContainer<1, 0, 1> MyParticleContainer;
+
+static Real particle_cost = 0.0;
+
+//
+// A smooth function of the cell center.
+//
+static
+Real
+Value (const Real* x)
+{
+    return AMREX_D_TERM(std::sin(6.0*x[0]), + std::cos(4.0*x[1]), + x[2]*x[2]);
+}
+
+//
+// The cost of a grid of a domain of n cells across, without its particles.
+//
+static
+Real
+GridCost (const Box& bx, int n)
+{
+    return (bx.smallEnd(0) < n/4 && bx.smallEnd(1) < n/4) ? 1000.0 : 100.0;
+}
+
+//
+// A number in [0,1) that depends on a, b and c only.
+//
+static
+Real
+Hash (long a, long b, long c)
+{
+    unsigned long h = 14695981039346656037UL;
+    for (unsigned long v : {(unsigned long) a, (unsigned long) b, (unsigned long) c}) {
+        h ^= v;
+        h *= 1099511628211UL;
+        h ^= h >> 29;
+    }
+    return Real(h >> 11) / Real(1UL << 53);
+}
+
+static
+void
+AddParticles (MyParticleContainer& pc)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Box& domain = geom.Domain();
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& ptile = pc.GetParticles()[0][std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+        const Box& bx = mfi.tilebox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            MyParticleContainer::ParticleType p;
+            p.id()  = 1 + domain.index(iv);
+            p.cpu() = ParallelDescriptor::MyProc();
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                p.pos(d) = plo[d] + (iv[d] + 0.2 + 0.6*Hash(p.id(), d, -1)) * dx[d];
+            }
+            p.rdata(0) = p.id();
+            ptile.push_back(p);
+        }
+    }
+}
+
+//
+// Move every particle within its cell and set its data, both given by its
+// id and the step, so that both containers see the same.
+//
+static
+void
+Move (MyParticleContainer& pc, int step)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (auto& kv : pc.GetParticles(0))
+    {
+        auto& aos = kv.second.GetArrayOfStructs();
+        for (int i = 0; i < aos.numParticles(); ++i) {
+            auto& p = aos[i];
+            const IntVect iv = pc.Index(p, 0);
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                const Real s = 0.5 + 0.3*std::sin(1.3*step + 7.0*Hash(p.id(), d, -2));
+                p.pos(d) = plo[d] + (iv[d] + s) * dx[d];
+            }
+            p.rdata(0) = p.id() + 0.25*step;
+        }
+    }
+}
+
+//
+// The domain is periodic, so this is never called.
+//
+extern "C"
+void
+nofill (Real* data, const int* lo, const int* hi,
+        const int* dom_lo, const int* dom_hi, const Real* dx, const Real* grd_lo,
+        const Real* time, const int* bc)
+{}
+
+extern "C"
+void
+amrex_probinit (const int* init, const int* name, const int* namelen,
+                const amrex_real* problo, const amrex_real* probhi)
+{}
+
+class CostLevel
+    : public AmrLevel
+{
+public:
+
+    CostLevel () {}
+
+    CostLevel (Amr& papa, int lev, const Geometry& level_geom, const BoxArray& bl,
+               const DistributionMapping& dm, Real time)
+        : AmrLevel(papa, lev, level_geom, bl, dm, time) {}
+
+    static void variableSetUp ();
+
+    static void variableCleanUp () { desc_lst.clear(); }
+
+    virtual void computeInitialDt (int finest_level, int sub_cycle, Array<int>& n_cycle,
+                                   const Array<IntVect>& ref_ratio, Array<Real>& dt_level,
+                                   Real stop_time) override
+    {
+        dt_level[0] = 0.01;
+    }
+
+    virtual void computeNewDt (int finest_level, int sub_cycle, Array<int>& n_cycle,
+                               const Array<IntVect>& ref_ratio, Array<Real>& dt_min,
+                               Array<Real>& dt_level, Real stop_time,
+                               int post_regrid_flag) override {}
+
+    //
+    // The state does not change.  The grids record their costs, and the
+    // particles move and update their neighbors.
+    //
+    virtual Real advance (Real time, Real dt, int iteration, int ncycle) override
+    {
+        state[0].allocOldData();
+        state[0].swapTimeLevels(dt);
+        MultiFab::Copy(get_new_data(0), get_old_data(0), 0, 0, 1, 0);
+
+        const int n = geom.Domain().length(0);
+        for (MFIter mfi(get_new_data(0)); mfi.isValid(); ++mfi) {
+            addBoxCost(mfi.index(), GridCost(mfi.validbox(), n));
+        }
+
+        if (pc)
+        {
+            const int step = parent->levelSteps(0) + 1;
+            Move(*pc, step);
+            Move(*ref, step);
+            pc->updateNeighbors(0);
+            ref->fillNeighbors(0);
+
+            int ndiff = 0;
+            for (const auto& kv : ref->neighbors) {
+                auto it = pc->neighbors.find(kv.first);
+                if (it == pc->neighbors.end() || it->second != kv.second) ++ndiff;
+            }
+            if (pc->neighbors.size() != ref->neighbors.size()) ++ndiff;
+            ParallelDescriptor::ReduceIntSum(ndiff);
+            neighbor_diffs += ndiff;
+
+            ref->clearNeighbors(0);
+        }
+
+        return dt;
+    }
+
+    virtual void post_timestep (int iteration) override {}
+
+    virtual void post_regrid (int lbase, int new_finest) override
+    {
+        if (pc) {
+            pc->Regrid(dmap, grids);
+            ref->Regrid(dmap, grids);
+        }
+    }
+
+    virtual void post_init (Real stop_time) override {}
+
+    virtual Array<long> NumberOfParticlesInGrid () const override
+    {
+        return pc ? pc->NumberOfParticlesInGrid(0, true, true) : Array<long>();
+    }
+
+    virtual void initData () override
+    {
+        const Real* dx = geom.CellSize();
+        MultiFab& S_new = get_new_data(0);
+        for (MFIter mfi(S_new); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            FArrayBox& fab = S_new[mfi];
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                Real x[BL_SPACEDIM];
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    x[d] = geom.ProbLo(d) + (iv[d] + 0.5) * dx[d];
+                }
+                fab(iv) = Value(x);
+            }
+        }
+    }
+
+    virtual void init (AmrLevel& old) override
+    {
+        const Real cur_time = old.get_state_data(0).curTime();
+        setTimeLevel(cur_time, 0.0, parent->dtLevel(level));
+        MultiFab& S_new = get_new_data(0);
+        FillPatch(old, S_new, 0, cur_time, 0, 0, 1);
+    }
+
+    virtual void init () override { amrex::Abort("CostLevel: there is only one level"); }
+
+    virtual void errorEst (TagBoxArray& tags, int clearval, int tagval, Real time,
+                           int n_error_buf, int ngrow) override {}
+
+    //
+    // The largest difference between the state and Value.
+    //
+    Real StateError () const
+    {
+        const Real* dx = geom.CellSize();
+        const MultiFab& S_new = const_cast<CostLevel*>(this)->get_new_data(0);
+        Real err = 0.0;
+        for (MFIter mfi(S_new); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            const FArrayBox& fab = S_new[mfi];
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                Real x[BL_SPACEDIM];
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    x[d] = geom.ProbLo(d) + (iv[d] + 0.5) * dx[d];
+                }
+                err = std::max(err, std::abs(fab(iv) - Value(x)));
+            }
+        }
+        ParallelDescriptor::ReduceRealMax(err);
+        return err;
+    }
+
+    // The particles of the level, and the ones whose neighbors are filled
+    // afresh every step.
+    static std::unique_ptr<MyParticleContainer> pc, ref;
+    static int neighbor_diffs;
+};
+
+std::unique_ptr<MyParticleContainer> CostLevel::pc;
+std::unique_ptr<MyParticleContainer> CostLevel::ref;
+int CostLevel::neighbor_diffs = 0;
+
+void
+CostLevel::variableSetUp ()
+{
+    BL_ASSERT(desc_lst.size() == 0);
+
+    int lo_bc[BL_SPACEDIM];
+    int hi_bc[BL_SPACEDIM];
+    for (int d = 0; d < BL_SPACEDIM; ++d) {
+        lo_bc[d] = hi_bc[d] = INT_DIR;
+    }
+    BCRec bc(lo_bc, hi_bc);
+
+    desc_lst.addDescriptor(0, IndexType::TheCellType(), StateDescriptor::Point,
+                           0, 1, &cell_cons_interp);
+    desc_lst.setComponent(0, 0, "phi", bc, StateDescriptor::BndryFunc(nofill));
+}
+
+class CostLevelBld
+    : public LevelBld
+{
+    virtual void variableSetUp () override { CostLevel::variableSetUp(); }
+
+    virtual void variableCleanUp () override { CostLevel::variableCleanUp(); }
+
+    virtual AmrLevel* operator() () override { return new CostLevel; }
+
+    virtual AmrLevel* operator() (Amr& papa, int lev, const Geometry& level_geom,
+                                  const BoxArray& ba, const DistributionMapping& dm,
+                                  Real time) override
+    {
+        return new CostLevel(papa, lev, level_geom, ba, dm, time);
+    }
+};
+
+CostLevelBld cost_bld;
+
+LevelBld*
+getLevelBld ()
+{
+    return &cost_bld;
+}
+
+//
+// The cost of the busiest process relative to the average.
+//
+static
+Real
+Imbalance (const Amr& amr)
+{
+    const BoxArray& ba = amr.boxArray(0);
+    const DistributionMapping& dm = amr.DistributionMap(0);
+    const int n = amr.Geom(0).Domain().length(0);
+    const Array<long> np = CostLevel::pc->NumberOfParticlesInGrid(0);
+
+    const int nprocs = ParallelDescriptor::NProcs();
+    Array<Real> proc_cost(nprocs, 0.0);
+    Real total = 0.0;
+    for (int i = 0; i < ba.size(); ++i) {
+        const Real c = GridCost(ba[i], n) + particle_cost*np[i];
+        proc_cost[dm[i]] += c;
+        total += c;
+    }
+    return *std::max_element(proc_cost.begin(), proc_cost.end()) / (total / nprocs);
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int max_step = 4;
+    {
+        ParmParse pp;
+        pp.query("max_step", max_step);
+        ParmParse ppamr("amr");
+        ppamr.query("loadbalance_particle_cost", particle_cost);
+    }
+
+    int nfail = 0;
+    {
+        Amr amr;
+        amr.init(0.0, 1.0);
+
+        CostLevel::pc .reset(new MyParticleContainer(amr.Geom(0), amr.DistributionMap(0), amr.boxArray(0), 1));
+        CostLevel::ref.reset(new MyParticleContainer(amr.Geom(0), amr.DistributionMap(0), amr.boxArray(0), 1));
+        for (auto* pc : {CostLevel::pc.get(), CostLevel::ref.get()}) {
+            AddParticles(*pc);
+            pc->Redistribute();
+        }
+        CostLevel::pc->fillNeighbors(0);
+
+        const long np0 = CostLevel::pc->TotalNumberOfParticles();
+        const Real imbalance0 = Imbalance(amr);
+        int nrebalanced = 0;
+
+        for (int step = 1; step <= max_step; ++step)
+        {
+            const DistributionMapping old_dm = amr.DistributionMap(0);
+            const Real old_imbalance = Imbalance(amr);
+
+            amr.coarseTimeStep(1.0);
+
+            const bool moved = !(amr.DistributionMap(0) == old_dm);
+            if (moved) ++nrebalanced;
+            const Real imbalance = Imbalance(amr);
+            const Real state_err = dynamic_cast<CostLevel&>(amr.getLevel(0)).StateError();
+            const long np = CostLevel::pc->TotalNumberOfParticles();
+
+            amrex::Print() << "step " << step << ": imbalance " << old_imbalance << " -> " << imbalance
+                           << (moved ? " (rebalanced)" : "") << ", state error " << state_err
+                           << ", " << np << " particles, "
+                           << CostLevel::neighbor_diffs << " tiles with different neighbors so far\n";
+
+            if (state_err != 0.0 || np != np0) ++nfail;
+            if (ParallelDescriptor::NProcs() > 1 && imbalance > 1.1 && step > 1) ++nfail;
+        }
+
+        if (CostLevel::neighbor_diffs != 0) ++nfail;
+        if (imbalance0 > 1.1 && nrebalanced == 0) {
+            amrex::Print() << "the grids were never rebalanced\n";
+            ++nfail;
+        }
+
+        CostLevel::pc.reset();
+        CostLevel::ref.reset();
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,192 @@
+//
+// A test of the order of the particles within a cell after
+// SortParticlesByCell.
+//
+//   mpirun -np 2 main.ex [n_cell=32] [max_grid_size=16] [nppc=4]
+//
+// The particles are put in random order in their tiles.  Particles in the
+// same cell must keep their relative order, both when the whole tile is
+// sorted (the first sort) and when only the particles that changed cell
+// are sorted and merged in (after moving some of them into the cells of
+// later particles).
+//
+
+#include <iostream>
+#include <utility>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+typedef ParticleContainer<1> MyParticleContainer;
+
+//
+// Put nppc particles at random places in each cell of our grids.
+//
+static
+void
+AddParticles (MyParticleContainer& pc, const Geometry& geom, int nppc)
+{
+    const BoxArray& ba = pc.ParticleBoxArray(0);
+    const DistributionMapping& dm = pc.ParticleDistributionMap(0);
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (int gid = 0; gid < ba.size(); ++gid)
+    {
+        if (dm[gid] != ParallelDescriptor::MyProc()) continue;
+        auto& ptile = pc.GetParticles()[0][std::make_pair(gid,0)];
+        const Box& bx = ba[gid];
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < nppc; ++n) {
+                MyParticleContainer::ParticleType p;
+                p.id()  = MyParticleContainer::ParticleType::NextID();
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + amrex::Random()) * dx[d];
+                }
+                p.rdata(0) = 0.0;
+                ptile.push_back(p);
+            }
+        }
+    }
+    //
+    // Shuffle the particles of each tile.
+    //
+    for (auto& kv : pc.GetParticles()[0])
+    {
+        auto& aos = kv.second.GetArrayOfStructs();
+        const int np = aos.numParticles();
+        for (int i = np-1; i > 0; --i) {
+            std::swap(aos[i], aos[amrex::Random_int(i+1)]);
+        }
+    }
+}
+
+//
+// Store the position of each particle in its tile in rdata(0).
+//
+static
+void
+Number (MyParticleContainer& pc)
+{
+    for (auto& kv : pc.GetParticles()[0])
+    {
+        auto& aos = kv.second.GetArrayOfStructs();
+        for (int i = 0; i < aos.numParticles(); ++i) {
+            aos[i].rdata(0) = i;
+        }
+    }
+}
+
+//
+// Every 10th particle moves to the position of the particle 5 places
+// further along in its tile, which is in the same grid.
+//
+static
+void
+MoveSome (MyParticleContainer& pc)
+{
+    for (auto& kv : pc.GetParticles()[0])
+    {
+        auto& aos = kv.second.GetArrayOfStructs();
+        const int np = aos.numParticles();
+        for (int i = 0; i+5 < np; i += 10) {
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                aos[i].pos(d) = aos[i+5].pos(d);
+            }
+        }
+    }
+}
+
+//
+// Returns the number of particles that are not in the cell their offset
+// says, or that come before a particle that used to be ahead of them in
+// the same cell.
+//
+static
+long
+CheckOrder (const MyParticleContainer& pc)
+{
+    long nbad = 0;
+    for (const auto& kv : pc.GetParticles()[0])
+    {
+        const auto& ptile = kv.second;
+        const auto& aos = ptile.GetArrayOfStructs();
+        const Box& cbox = ptile.GetCellBox();
+        const Array<int>& offsets = ptile.GetCellOffsets();
+        const int np = aos.numParticles();
+        if (np == 0) continue;
+
+        if (long(offsets.size()) != cbox.numPts()+1 || offsets.back() != np) {
+            nbad += np;
+            continue;
+        }
+
+        for (long k = 0; k < cbox.numPts(); ++k) {
+            for (int i = offsets[k]; i < offsets[k+1]; ++i) {
+                if (cbox.index(pc.Index(aos[i],0)) != k) ++nbad;
+                if (i > offsets[k] && !(aos[i-1].rdata(0) < aos[i].rdata(0))) ++nbad;
+            }
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(nbad);
+    return nbad;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell = 32;
+    int max_grid_size = 16;
+    int nppc = 4;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nppc", nppc);
+    }
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++) {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dmap(ba);
+
+    MyParticleContainer pc(geom, dmap, ba);
+
+    AddParticles(pc, geom, nppc);
+
+    int nfail = 0;
+
+    // Random order: most particles are out of place, so the whole tile is sorted.
+    Number(pc);
+    pc.SortParticlesByCell();
+    long nbad = CheckOrder(pc);
+    amrex::Print() << "full sort:   " << nbad << " particles out of order\n";
+    if (nbad != 0) ++nfail;
+
+    // Few particles changed cell, so they are sorted and merged in.
+    Number(pc);
+    MoveSome(pc);
+    pc.SortParticlesByCell();
+    nbad = CheckOrder(pc);
+    amrex::Print() << "merged sort: " << nbad << " particles out of order\n";
+    if (nbad != 0) ++nfail;
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,269 @@
+//
+// A test of the particle Checkpoint and Restart.
+//
+//   mpirun -np 4 main.ex [n_cell=32] [nppc=1]
+//
+// Particles with struct and struct-of-arrays data, on two levels, are
+// written in the Version_Two_Dot_One layout and read back
+//
+//   - on the same grids and DistributionMapping,
+//   - on the same grids owned by other processes,
+//   - on other grids,
+//   - with a GridFilter that takes part of the written grids.
+//
+// Every particle read must have the data it was written with, which are
+// functions of its id, and the number of particles and the sum of their
+// ids on each level must be those of the written particles (in the
+// grids the filter accepts).  OK() must hold after each Restart.
+//
+
+#include <iostream>
+#include <fstream>
+#include <utility>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+typedef ParticleContainer<2,1,2,1> MyParticleContainer;
+
+static const std::string chkdir("pchk");
+static const std::string chkname("particles");
+
+//
+// A number in [0,1) that depends on a and b only.
+//
+static
+Real
+Hash (long a, long b)
+{
+    unsigned long h = 14695981039346656037UL;
+    for (unsigned long v : {(unsigned long) a, (unsigned long) b}) {
+        h ^= v;
+        h *= 1099511628211UL;
+        h ^= h >> 29;
+    }
+    return Real(h >> 11) / Real(1UL << 53);
+}
+
+static
+void
+AddParticles (MyParticleContainer& pc, int nppc)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Box& domain = geom.Domain();
+    const Real* plo = geom.ProbLo();
+
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& ptile = pc.GetParticles()[0][std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+        const Box& bx = mfi.tilebox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < nppc; ++n) {
+                MyParticleContainer::ParticleType p;
+                p.id()  = 1 + domain.index(iv)*nppc + n;
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + Hash(p.id(), d)) * geom.CellSize(d);
+                }
+                p.rdata(0) = 0.5*p.id();
+                p.rdata(1) = -1.0*p.id();
+                p.idata(0) = 3*p.id();
+                ptile.push_back(p);
+                ptile.push_back_real(0, 1.5*p.id());
+                ptile.push_back_real(1, p.id() + 0.25);
+                ptile.push_back_int(0, p.id() % 7);
+            }
+        }
+    }
+}
+
+//
+// The number of particles on the level that do not have the data of their
+// id, over all processes.
+//
+static
+long
+CheckData (const MyParticleContainer& pc, int lev, int nppc)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Box& domain = geom.Domain();
+    const Real* plo = geom.ProbLo();
+
+    long nbad = 0;
+    for (const auto& kv : pc.GetParticles(lev))
+    {
+        const auto& aos = kv.second.GetArrayOfStructs();
+        const auto& soa = kv.second.GetStructOfArrays();
+        for (int i = 0; i < aos.numParticles(); ++i)
+        {
+            const auto& p = aos[i];
+            if (p.id() <= 0) continue;
+            bool ok = p.rdata(0) == 0.5*p.id() && p.rdata(1) == -1.0*p.id() && p.idata(0) == 3*p.id()
+                && soa.GetRealData(0)[i] == 1.5*p.id() && soa.GetRealData(1)[i] == p.id() + 0.25
+                && soa.GetIntData(0)[i] == p.id() % 7;
+            // The cell follows from the id, and the place in it from a hash.
+            IntVect iv;
+            long offset = (p.id()-1) / nppc;
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                iv[d] = domain.smallEnd(d) + offset % domain.length(d);
+                offset /= domain.length(d);
+            }
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                ok = ok && p.pos(d) == plo[d] + (iv[d] + Hash(p.id(), d)) * geom.CellSize(d);
+            }
+            if (!ok) ++nbad;
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(nbad);
+    return nbad;
+}
+
+//
+// The number of particles and the sum of their ids on the level, counting
+// only the particles in the grids the filter accepts, over all processes.
+//
+static
+std::pair<long,long>
+Sums (const MyParticleContainer& pc, int lev, const MyParticleContainer::GridFilter& filter)
+{
+    const BoxArray& ba = pc.ParticleBoxArray(lev);
+    long np = 0, idsum = 0;
+    for (const auto& kv : pc.GetParticles(lev))
+    {
+        if (filter && !filter(lev, ba[kv.first.first])) continue;
+        const auto& aos = kv.second.GetArrayOfStructs();
+        for (int i = 0; i < aos.numParticles(); ++i) {
+            if (aos[i].id() <= 0) continue;
+            ++np;
+            idsum += aos[i].id();
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(np);
+    ParallelDescriptor::ReduceLongSum(idsum);
+    return std::make_pair(np, idsum);
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell = 32;
+    int nppc = 1;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("nppc", nppc);
+    }
+
+    const int nlevs = 2;
+    Array<int> rr(nlevs-1, 2);
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++) {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    Array<Geometry> geom(nlevs);
+    geom[0].define(domain, &real_box, CoordSys::cartesian, is_per);
+    geom[1].define(amrex::refine(domain, rr[0]), &real_box, CoordSys::cartesian, is_per);
+
+    const Box fine_box(IntVect(AMREX_D_DECL(n_cell/2,n_cell/2,n_cell/2)),
+                       IntVect(AMREX_D_DECL(3*n_cell/2-1,3*n_cell/2-1,3*n_cell/2-1)));
+
+    //
+    // The grids written on, and other grids covering the same region.
+    //
+    Array<BoxArray> ba(nlevs), other_ba(nlevs);
+    Array<DistributionMapping> dm(nlevs), rotated_dm(nlevs), other_dm(nlevs);
+    for (int lev = 0; lev < nlevs; ++lev) {
+        const Box& bx = (lev == 0) ? domain : fine_box;
+        ba[lev].define(bx);
+        ba[lev].maxSize(16);
+        dm[lev].define(ba[lev]);
+        other_ba[lev].define(bx);
+        other_ba[lev].maxSize(IntVect(AMREX_D_DECL(32,8,4)));
+        other_dm[lev].define(other_ba[lev]);
+
+        Array<int> pmap = dm[lev].ProcessorMap();
+        for (int& p : pmap) p = (p + 1) % ParallelDescriptor::NProcs();
+        rotated_dm[lev] = DistributionMapping(pmap);
+    }
+
+    MyParticleContainer pc(geom, dm, ba, rr);
+    AddParticles(pc, nppc);
+    pc.Redistribute();
+
+    if (ParallelDescriptor::IOProcessor()) {
+        if (!amrex::UtilCreateDirectory(chkdir, 0755)) amrex::CreateDirectoryFailed(chkdir);
+    }
+    ParallelDescriptor::Barrier();
+    pc.Checkpoint(chkdir, chkname);
+
+    int nfail = 0;
+
+    if (ParallelDescriptor::IOProcessor()) {
+        std::ifstream hdr(chkdir + "/" + chkname + "/Header");
+        std::string version;
+        hdr >> version;
+        if (version.find("Version_Two_Dot_One") != 0) {
+            amrex::Print() << "written as " << version << "\n";
+            ++nfail;
+        }
+    }
+
+    //
+    // Take the written level 0 grids in the lower half in x, and all the
+    // level 1 grids.
+    //
+    const MyParticleContainer::GridFilter half = [n_cell] (int lev, const Box& bx) {
+        return lev > 0 || bx.smallEnd(0) < n_cell/2;
+    };
+
+    struct Case {
+        std::string name;
+        const Array<BoxArray>* ba;
+        const Array<DistributionMapping>* dm;
+        MyParticleContainer::GridFilter filter;
+    };
+    const Case cases[] = {
+        { "same layout",       &ba,       &dm,         MyParticleContainer::GridFilter() },
+        { "other owners",      &ba,       &rotated_dm, MyParticleContainer::GridFilter() },
+        { "other grids",       &other_ba, &other_dm,   MyParticleContainer::GridFilter() },
+        { "filter, same grids",  &ba,       &dm,       half },
+        { "filter, other grids", &other_ba, &other_dm, half }
+    };
+
+    for (const Case& c : cases)
+    {
+        MyParticleContainer restarted(geom, *c.dm, *c.ba, rr);
+        restarted.Restart(chkdir, chkname, true, c.filter);
+
+        const bool ok = restarted.OK();
+        amrex::Print() << c.name << ":" << (ok ? "" : " NOT OK");
+        if (!ok) ++nfail;
+
+        for (int lev = 0; lev < nlevs; ++lev)
+        {
+            // The particles were written on level lev and are read back there.
+            const std::pair<long,long> written = Sums(pc, lev, c.filter);
+            const std::pair<long,long> read    = Sums(restarted, lev, MyParticleContainer::GridFilter());
+            const long nbad = CheckData(restarted, lev, nppc);
+            amrex::Print() << " level " << lev << " " << read.first << " particles of "
+                           << written.first << ", " << nbad << " with wrong data;";
+            if (read != written || nbad != 0) ++nfail;
+        }
+        amrex::Print() << "\n";
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,170 @@
+//
+// A test of AssignCellDensitySingleLevelFort with
+// particles.colored_deposition.
+//
+//   OMP_NUM_THREADS=4 mpirun -np 2 main.ex [n_cell=32] [max_grid_size=16] [nppc=2]
+//
+// Particles with random masses are deposited with and without the colored
+// tiles, without tiling and with tiles of 16^3, 8^3, 1024x2x2 (2^D colors)
+// and 1024x1x1 (3^D colors, or none with two ghost cells, when the scratch
+// fab path is used).  The densities must agree to round-off, and their sum
+// must be the total mass.  Within a color returned by ColorTiles, no two
+// tiles of a grid may reach the same cells.
+//
+
+#include <iostream>
+#include <utility>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+typedef ParticleContainer<1> MyParticleContainer;
+
+//
+// Put nppc particles at random places in each cell of our grids, in the
+// tiles they belong to.  Returns the total mass.
+//
+static
+Real
+AddParticles (MyParticleContainer& pc, int nppc)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    Real mass = 0.0;
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& ptile = pc.GetParticles()[0][std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+        const Box& bx = mfi.tilebox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < nppc; ++n) {
+                MyParticleContainer::ParticleType p;
+                p.id()  = MyParticleContainer::ParticleType::NextID();
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + amrex::Random()) * dx[d];
+                }
+                p.rdata(0) = 0.5 + amrex::Random();
+                mass += p.rdata(0);
+                ptile.push_back(p);
+            }
+        }
+    }
+    ParallelDescriptor::ReduceRealSum(mass);
+    return mass;
+}
+
+//
+// The number of pairs of tiles of the same grid and color whose cells,
+// grown by reach, overlap.
+//
+static
+int
+CheckColors (const MyParticleContainer& pc, int reach,
+             const Array<Array<std::pair<int,int> > >& colors)
+{
+    std::map<std::pair<int,int>, Box> tileboxes;
+    for (ParConstIter<1> pti(pc, 0); pti.isValid(); ++pti) {
+        tileboxes[std::make_pair(pti.index(), pti.LocalTileIndex())] = pti.tilebox();
+    }
+
+    int nbad = 0;
+    for (const auto& tiles : colors) {
+        for (int i = 0; i < tiles.size(); ++i) {
+            for (int j = i+1; j < tiles.size(); ++j) {
+                if (tiles[i].first != tiles[j].first) continue;
+                const Box& a = tileboxes[tiles[i]];
+                const Box& b = tileboxes[tiles[j]];
+                if (amrex::grow(a,reach).intersects(amrex::grow(b,reach))) ++nbad;
+            }
+        }
+    }
+    ParallelDescriptor::ReduceIntSum(nbad);
+    return nbad;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell = 32;
+    int max_grid_size = 16;
+    int nppc = 2;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nppc", nppc);
+    }
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++) {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+    const Real* dx = geom.CellSize();
+    const Real vol = AMREX_D_TERM(dx[0], *dx[1], *dx[2]);
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dmap(ba);
+
+    struct Case { bool tiling; IntVect tile_size; int ngrow; int ncolors; };
+    const int D3 = AMREX_D_TERM(3, *3, *3);
+    const int D2 = AMREX_D_TERM(2, *2, *2);
+    const Case cases[] = {
+        { false, IntVect::TheZeroVector(),         1, D2 },
+        { true,  IntVect(AMREX_D_DECL(16,16,16)),  1, D2 },
+        { true,  IntVect(AMREX_D_DECL(8,8,8)),     1, D2 },
+        { true,  IntVect(AMREX_D_DECL(1024,2,2)),  1, D2 },
+        { true,  IntVect(AMREX_D_DECL(1024,1,1)),  1, D3 },
+        { true,  IntVect(AMREX_D_DECL(1024,1,1)),  2, 0  }
+    };
+
+    int nfail = 0;
+
+    for (const Case& c : cases)
+    {
+        MyParticleContainer::do_tiling = c.tiling;
+        MyParticleContainer::tile_size = c.tile_size;
+
+        MyParticleContainer pc(geom, dmap, ba);
+        const Real mass = AddParticles(pc, nppc);
+
+        MultiFab rho_scratch(ba, dmap, 1, c.ngrow);
+        MultiFab rho_colored(ba, dmap, 1, c.ngrow);
+
+        MyParticleContainer::colored_deposition = false;
+        pc.AssignCellDensitySingleLevelFort(0, rho_scratch, 0);
+        MyParticleContainer::colored_deposition = true;
+        pc.AssignCellDensitySingleLevelFort(0, rho_colored, 0);
+
+        Array<Array<std::pair<int,int> > > colors;
+        int ncolors = pc.ColorTiles(0, c.ngrow, colors);
+        ParallelDescriptor::ReduceIntMax(ncolors);
+        const int nbad = CheckColors(pc, c.ngrow, colors);
+
+        MultiFab::Subtract(rho_colored, rho_scratch, 0, 0, 1, 0);
+        const Real diff = rho_colored.norm0(0) / rho_scratch.norm0(0);
+        const Real mass_err = std::abs(rho_scratch.sum(0)*vol - mass) / mass;
+
+        amrex::Print() << "tiling " << c.tiling << " " << c.tile_size << " ngrow " << c.ngrow
+                       << ": " << ncolors << " colors, " << nbad << " overlapping tiles, "
+                       << "relative difference " << diff << ", mass error " << mass_err << "\n";
+
+        if (ncolors != c.ncolors || nbad != 0 || diff > 1.e-14 || mass_err > 1.e-12) ++nfail;
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,243 @@
+//
+// A test of the deposition kernels of AMReX_ParticleKernels.H.
+//
+//   main.ex [n_cell=32] [nparticles=100000]
+//
+// Particles with random masses are put at random places in the domain,
+// and deposited on a fab with SoADepositCIC and SoADepositTSC.  The cloud
+// in cell result must agree with the Fortran amrex_deposit_cic, and the
+// triangular shaped cloud one with a cell by cell evaluation of the
+// TSC weight function.  The sum over the mesh must be the total mass.
+// Single particles at a cell center and at a node, whose weights are
+// known, are checked too.
+//
+
+#include <iostream>
+#include <cmath>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+#include <AMReX_Particles_F.H>
+#include <AMReX_ParticleKernels.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+typedef ArrayOfStructs<1,0> MyAoS;
+typedef SoAParticles<1,0>   MySoA;
+
+static
+void
+AddParticle (MyAoS& aos, const Real* x, Real mass)
+{
+    MyAoS::ParticleType p;
+    p.id()  = MyAoS::ParticleType::NextID();
+    p.cpu() = ParallelDescriptor::MyProc();
+    for (int d = 0; d < BL_SPACEDIM; ++d) {
+        p.pos(d) = x[d];
+    }
+    p.rdata(0) = mass;
+    aos.push_back(p);
+}
+
+//
+// The TSC weight of a particle at len (in units of the cell size from
+// the lower corner of the domain) for the cell i.
+//
+static
+Real
+TSCWeight (Real len, int i)
+{
+    const Real x = std::abs(len - (i + 0.5));
+    if (x < 0.5) return 0.75 - x*x;
+    if (x < 1.5) return 0.5*(1.5 - x)*(1.5 - x);
+    return 0.0;
+}
+
+static
+void
+DepositTSCReference (const MyAoS& aos, FArrayBox& fab, const Real* plo, const Real* dx)
+{
+    const Box& bx = fab.box();
+    for (int n = 0; n < aos.numParticles(); ++n)
+    {
+        const auto& p = aos[n];
+        Real len[BL_SPACEDIM];
+        IntVect iv;
+        for (int d = 0; d < BL_SPACEDIM; ++d) {
+            len[d] = (p.pos(d) - plo[d]) / dx[d];
+            iv[d]  = static_cast<int>(std::floor(len[d]));
+        }
+        const Box sbx(iv - 2, iv + 2);
+        for (IntVect c = sbx.smallEnd(); c <= sbx.bigEnd(); sbx.next(c)) {
+            Real w = 1.0;
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                w *= TSCWeight(len[d], c[d]);
+            }
+            if (w != 0.0) {
+                BL_ASSERT(bx.contains(c));
+                fab(c) += w * p.rdata(0);
+            }
+        }
+    }
+}
+
+static
+Real
+MaxDiff (const FArrayBox& a, const FArrayBox& b)
+{
+    FArrayBox d(a.box(), 1);
+    d.copy(a);
+    d.minus(b);
+    return d.norm(0);
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell = 32;
+    int nparticles = 100000;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("nparticles", nparticles);
+    }
+    //
+    // A domain that is not at the origin, with cells of different sizes
+    // in each direction.
+    //
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    Real plo[BL_SPACEDIM], phi[BL_SPACEDIM], dx[BL_SPACEDIM], dxi[BL_SPACEDIM];
+    for (int d = 0; d < BL_SPACEDIM; ++d) {
+        plo[d] = -0.3 + 0.1*d;
+        phi[d] = plo[d] + 1.0 + 0.5*d;
+        dx[d]  = (phi[d] - plo[d]) / n_cell;
+        dxi[d] = 1.0 / dx[d];
+    }
+    //
+    // The particles are in the domain, so their stencils are in the domain
+    // grown by two.
+    //
+    const Box bx = amrex::grow(domain, 2);
+    const int* lo = bx.loVect();
+    const int* hi = bx.hiVect();
+
+    int nfail = 0;
+
+    MyAoS aos;
+    Real total = 0.0;
+    for (int n = 0; n < nparticles; ++n) {
+        Real x[BL_SPACEDIM];
+        for (int d = 0; d < BL_SPACEDIM; ++d) {
+            x[d] = plo[d] + amrex::Random() * (phi[d] - plo[d]);
+        }
+        const Real mass = 0.5 + amrex::Random();
+        AddParticle(aos, x, mass);
+        total += mass;
+    }
+
+    MySoA soa;
+    ParticlesToSoA(aos, soa);
+
+    FArrayBox rho_f(bx, 1), rho_k(bx, 1);
+    //
+    // Cloud in cell, against the Fortran deposition.
+    //
+    rho_f.setVal(0.0);
+    rho_k.setVal(0.0);
+    amrex_deposit_cic(aos.data(), aos.dataShape().first, aos.numParticles(), 1,
+                      rho_f.dataPtr(), lo, hi, plo, dx);
+    SoADepositCIC<0>(soa, rho_k, 0, plo, dxi);
+    {
+        const Real diff = MaxDiff(rho_k, rho_f) / rho_f.norm(0);
+        const Real sum  = rho_k.sum(0);
+        amrex::Print() << "CIC: rel. diff to Fortran " << diff
+                       << ", sum - total mass " << sum - total << "\n";
+        if (diff > 1.e-12 || std::abs(sum - total) > 1.e-10*total) ++nfail;
+    }
+    //
+    // Triangular shaped cloud, against the weight function.
+    //
+    rho_f.setVal(0.0);
+    rho_k.setVal(0.0);
+    DepositTSCReference(aos, rho_f, plo, dx);
+    SoADepositTSC<0>(soa, rho_k, 0, plo, dxi);
+    {
+        const Real diff = MaxDiff(rho_k, rho_f) / rho_f.norm(0);
+        const Real sum  = rho_k.sum(0);
+        amrex::Print() << "TSC: rel. diff to reference " << diff
+                       << ", sum - total mass " << sum - total << "\n";
+        if (diff > 1.e-12 || std::abs(sum - total) > 1.e-10*total) ++nfail;
+    }
+    //
+    // The factor scales the deposit.
+    //
+    rho_f.setVal(0.0);
+    SoADepositTSC<0>(soa, rho_f, 0, plo, dxi, 2.0);
+    rho_k.mult(2.0);
+    if (MaxDiff(rho_k, rho_f) > 1.e-12 * rho_f.norm(0)) {
+        amrex::Print() << "TSC: the factor is not applied\n";
+        ++nfail;
+    }
+    //
+    // A particle at the center of a cell goes all into the cell with CIC, and
+    // with weights 3/4 for the cell and 1/8 for each neighbor per direction
+    // with TSC.  A particle at a node is shared equally by the 2^D cells
+    // around it with both.
+    //
+    const IntVect iv(AMREX_D_DECL(n_cell/2, n_cell/3, n_cell/4));
+    const Box nbx(iv - 1, iv);
+    for (int at_node = 0; at_node < 2; ++at_node)
+    {
+        Real x[BL_SPACEDIM];
+        for (int d = 0; d < BL_SPACEDIM; ++d) {
+            x[d] = plo[d] + (iv[d] + (at_node ? 0.0 : 0.5)) * dx[d];
+        }
+        MyAoS one;
+        AddParticle(one, x, 1.0);
+        MySoA one_soa;
+        ParticlesToSoA(one, one_soa);
+
+        for (int tsc = 0; tsc < 2; ++tsc)
+        {
+            rho_k.setVal(0.0);
+            if (tsc) {
+                SoADepositTSC<0>(one_soa, rho_k, 0, plo, dxi);
+            } else {
+                SoADepositCIC<0>(one_soa, rho_k, 0, plo, dxi);
+            }
+
+            Real err = 0.0;
+            for (IntVect c = bx.smallEnd(); c <= bx.bigEnd(); bx.next(c)) {
+                Real w;
+                if (at_node) {
+                    w = nbx.contains(c) ? std::pow(0.5, BL_SPACEDIM) : 0.0;
+                }
+                else if (tsc) {
+                    w = 1.0;
+                    for (int d = 0; d < BL_SPACEDIM; ++d) {
+                        const int off = std::abs(c[d] - iv[d]);
+                        w *= (off == 0) ? 0.75 : (off == 1 ? 0.125 : 0.0);
+                    }
+                }
+                else {
+                    w = (c == iv) ? 1.0 : 0.0;
+                }
+                err = std::max(err, std::abs(rho_k(c) - w));
+            }
+            amrex::Print() << (tsc ? "TSC" : "CIC") << ": particle at a "
+                           << (at_node ? "node" : "cell center")
+                           << ", max weight error " << err << "\n";
+            if (err > 1.e-12) ++nfail;
+        }
+    }
+
+    ParallelDescriptor::ReduceIntMax(nfail);
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
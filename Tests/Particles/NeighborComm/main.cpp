@@ -0,0 +1,191 @@
+//
+// A test of the neighbor communication plan of NeighborParticleContainer.
+//
+//   mpirun -np 4 main.ex [n_cell=16] [max_grid_size=8] [nppc=2] [nsteps=10]
+//
+// Three containers are given the same particles in a periodic domain.
+// Every step the particles move within their cells and their data change.
+// Two containers call fillNeighbors once and then updateNeighbors every
+// step, so both their plans are alive and reused at the same time.  The
+// third calls fillNeighbors and clearNeighbors every step, and other
+// messages are sent on the default communicator in between.  The
+// neighbor buffers of the first two must be the same as the third's
+// after every step.
+//
+
+#include <iostream>
+#include <cmath>
+#include <utility>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_NeighborParticles.H>
+
+using namespace amrex;
+
+typedef NeighborParticleContainer<1, 0, 1> MyParticleContainer;
+
+//
+// A number in [0,1) that depends on a, b and c only.
+//
+static
+Real
+Hash (long a, long b, long c)
+{
+    unsigned long h = 14695981039346656037UL;
+    for (unsigned long v : {(unsigned long) a, (unsigned long) b, (unsigned long) c}) {
+        h ^= v;
+        h *= 1099511628211UL;
+        h ^= h >> 29;
+    }
+    return Real(h >> 11) / Real(1UL << 53);
+}
+
+static
+void
+AddParticles (MyParticleContainer& pc, int nppc)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Box& domain = geom.Domain();
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& ptile = pc.GetParticles()[0][std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+        const Box& bx = mfi.tilebox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < nppc; ++n) {
+                MyParticleContainer::ParticleType p;
+                p.id()  = 1 + domain.index(iv)*nppc + n;
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + 0.2 + 0.6*Hash(p.id(), d, -1)) * dx[d];
+                }
+                p.rdata(0) = p.id();
+                ptile.push_back(p);
+            }
+        }
+    }
+}
+
+//
+// Move every particle to a place in its cell and set its data, both given
+// by its id and the step, so that the neighbors stay the same.
+//
+static
+void
+Move (MyParticleContainer& pc, int step)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (auto& kv : pc.GetParticles(0))
+    {
+        auto& aos = kv.second.GetArrayOfStructs();
+        for (int i = 0; i < aos.numParticles(); ++i) {
+            auto& p = aos[i];
+            const IntVect iv = pc.Index(p, 0);
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                const Real s = 0.5 + 0.3*std::sin(1.3*step + 7.0*Hash(p.id(), d, -2));
+                p.pos(d) = plo[d] + (iv[d] + s) * dx[d];
+            }
+            p.rdata(0) = p.id() + 0.25*step;
+        }
+    }
+}
+
+//
+// The number of tiles whose neighbor buffers differ, over all processes.
+//
+static
+int
+Compare (const MyParticleContainer& a, const MyParticleContainer& b)
+{
+    int ndiff = 0;
+    for (const auto& kv : b.neighbors) {
+        auto it = a.neighbors.find(kv.first);
+        if (it == a.neighbors.end() || it->second != kv.second) ++ndiff;
+    }
+    if (a.neighbors.size() != b.neighbors.size()) ++ndiff;
+    ParallelDescriptor::ReduceIntSum(ndiff);
+    return ndiff;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell = 16;
+    int max_grid_size = 8;
+    int nppc = 2;
+    int nsteps = 10;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nppc", nppc);
+        pp.query("nsteps", nsteps);
+    }
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++) {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dmap(ba);
+
+    const int lev = 0;
+
+    MyParticleContainer pc_a(geom, dmap, ba, 1);
+    MyParticleContainer pc_b(geom, dmap, ba, 1);
+    MyParticleContainer pc_ref(geom, dmap, ba, 1);
+    for (MyParticleContainer* pc : {&pc_a, &pc_b, &pc_ref}) {
+        AddParticles(*pc, nppc);
+        pc->Redistribute();
+    }
+
+    pc_a.fillNeighbors(lev);
+    pc_b.fillNeighbors(lev);
+
+    int nfail = 0;
+
+    for (int step = 1; step <= nsteps; ++step)
+    {
+        for (MyParticleContainer* pc : {&pc_a, &pc_b, &pc_ref}) {
+            Move(*pc, step);
+        }
+
+        pc_ref.fillNeighbors(lev);
+
+        // Messages on the default communicator, which must not be taken
+        // for neighbor data.
+        Array<long> counts = pc_ref.NumberOfParticlesInGrid(lev);
+
+        pc_b.updateNeighbors(lev);
+        ParallelDescriptor::Barrier();
+        pc_a.updateNeighbors(lev);
+
+        const int ndiff_a = Compare(pc_a, pc_ref);
+        const int ndiff_b = Compare(pc_b, pc_ref);
+
+        amrex::Print() << "step " << step << ": " << counts.size() << " grids, "
+                       << ndiff_a << " and " << ndiff_b << " tiles with different neighbors\n";
+
+        if (ndiff_a != 0 || ndiff_b != 0) ++nfail;
+
+        pc_ref.clearNeighbors(lev);
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
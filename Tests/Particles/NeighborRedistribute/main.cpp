@@ -0,0 +1,250 @@
+//
+// A test of Redistribute with particles.neighbor_redistribute.
+//
+//   mpirun -np 4 main.ex [n_cell=32] [max_grid_size=8] [nppc=2] [nsteps=12]
+//
+// Two levels, periodic in x and y but not in z.  Two containers are given
+// the same particles and the same moves; one is redistributed with the
+// neighbor-only exchange and the other with the global one.  The moves
+// are mostly less than a coarse cell, but every fourth step some
+// particles jump 0.3 of the domain, which the neighbor exchange must hand
+// to the global one.  After every step, the number of particles, the sum
+// of their ids and of their ids times their cell in each grid of each
+// level must be the same for both, the attributes must still be the ids,
+// and OK() must hold.
+//
+
+#include <iostream>
+#include <utility>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+
+using namespace amrex;
+
+typedef ParticleContainer<1,1> MyParticleContainer;
+
+//
+// A number in [0,1) that depends on a, b and c only, so that both
+// containers, on any number of processes, see the same.
+//
+static
+Real
+Hash (long a, long b, long c)
+{
+    unsigned long h = 14695981039346656037UL;
+    for (unsigned long v : {(unsigned long) a, (unsigned long) b, (unsigned long) c}) {
+        h ^= v;
+        h *= 1099511628211UL;
+        h ^= h >> 29;
+    }
+    return Real(h >> 11) / Real(1UL << 53);
+}
+
+//
+// Put nppc particles in each cell of our level 0 grids.
+//
+static
+void
+AddParticles (MyParticleContainer& pc, int nppc)
+{
+    const Geometry& geom = pc.Geom(0);
+    const BoxArray& ba = pc.ParticleBoxArray(0);
+    const DistributionMapping& dm = pc.ParticleDistributionMap(0);
+    const Box& domain = geom.Domain();
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (int gid = 0; gid < ba.size(); ++gid)
+    {
+        if (dm[gid] != ParallelDescriptor::MyProc()) continue;
+        auto& ptile = pc.GetParticles()[0][std::make_pair(gid,0)];
+        const Box& bx = ba[gid];
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < nppc; ++n) {
+                MyParticleContainer::ParticleType p;
+                p.id()  = 1 + domain.index(iv)*nppc + n;
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + Hash(p.id(), d, -1)) * dx[d];
+                }
+                p.rdata(0) = p.id();
+                p.idata(0) = p.id();
+                ptile.push_back(p);
+            }
+        }
+    }
+}
+
+//
+// Move every particle by up to half a coarse cell in each direction, and
+// one in fifty by 0.3 of the domain on the steps that are multiples of 4.
+// Particles are kept inside in z by reflection.
+//
+static
+void
+Move (MyParticleContainer& pc, int step)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+    const Real* phi = geom.ProbHi();
+
+    for (int lev = 0; lev <= pc.finestLevel(); ++lev)
+    {
+        for (auto& kv : pc.GetParticles(lev))
+        {
+            auto& aos = kv.second.GetArrayOfStructs();
+            for (int i = 0; i < aos.numParticles(); ++i)
+            {
+                auto& p = aos[i];
+                const bool jump = (step % 4 == 0) && (p.id() % 50 == step % 50);
+                for (int d = 0; d < BL_SPACEDIM; ++d)
+                {
+                    const Real r = Hash(p.id(), step, d) - 0.5;
+                    p.pos(d) += jump ? 0.3*(phi[d]-plo[d])*(r < 0.0 ? -1.0 : 1.0) : r*dx[d];
+                    if (!geom.isPeriodic(d)) {
+                        if (p.pos(d) < plo[d]) p.pos(d) = 2.0*plo[d] - p.pos(d);
+                        if (p.pos(d) >= phi[d]) p.pos(d) = 2.0*phi[d] - p.pos(d) - 1.e-10*dx[d];
+                    }
+                }
+            }
+        }
+    }
+}
+
+//
+// For each grid of the level, the number of particles, the sum of their
+// ids and the sum of their ids times the index of their cell.  Particles
+// whose attributes are not their ids are counted in nbad.
+//
+static
+Array<long>
+GridSums (const MyParticleContainer& pc, int lev, long& nbad)
+{
+    const BoxArray& ba = pc.ParticleBoxArray(lev);
+    const Box& domain = pc.Geom(lev).Domain();
+    Array<long> sums(3*ba.size(), 0);
+
+    for (const auto& kv : pc.GetParticles(lev))
+    {
+        const int gid = kv.first.first;
+        const auto& aos = kv.second.GetArrayOfStructs();
+        for (int i = 0; i < aos.numParticles(); ++i)
+        {
+            const auto& p = aos[i];
+            if (p.id() <= 0) continue;
+            sums[3*gid  ] += 1;
+            sums[3*gid+1] += p.id();
+            sums[3*gid+2] += p.id() * domain.index(pc.Index(p,lev));
+            if (p.rdata(0) != p.id() || p.idata(0) != p.id()) ++nbad;
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(sums.dataPtr(), sums.size());
+    return sums;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell = 32;
+    int max_grid_size = 8;
+    int nppc = 2;
+    int nsteps = 12;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nppc", nppc);
+        pp.query("nsteps", nsteps);
+    }
+
+    const int nlevs = 2;
+    Array<int> rr(nlevs-1, 2);
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++) {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,0)};
+
+    Array<Geometry> geom(nlevs);
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    geom[0].define(domain, &real_box, CoordSys::cartesian, is_per);
+    geom[1].define(amrex::refine(domain, rr[0]), &real_box, CoordSys::cartesian, is_per);
+
+    //
+    // The fine level covers a corner of the domain, so that it is cut by
+    // the periodic boundaries, and a block in the middle.
+    //
+    Array<BoxArray> ba(nlevs);
+    ba[0].define(domain);
+    BoxList fine;
+    fine.push_back(Box(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell/2-1,n_cell/2-1,n_cell/2-1))));
+    fine.push_back(Box(IntVect(AMREX_D_DECL(n_cell,n_cell,n_cell)),
+                       IntVect(AMREX_D_DECL(3*n_cell/2-1,3*n_cell/2-1,3*n_cell/2-1))));
+    ba[1].define(fine);
+
+    Array<DistributionMapping> dmap(nlevs);
+    for (int lev = 0; lev < nlevs; lev++) {
+        ba[lev].maxSize(max_grid_size);
+        dmap[lev].define(ba[lev]);
+    }
+
+    MyParticleContainer pc_neighbor(geom, dmap, ba, rr);
+    MyParticleContainer pc_global  (geom, dmap, ba, rr);
+
+    AddParticles(pc_neighbor, nppc);
+    AddParticles(pc_global, nppc);
+
+    int nfail = 0;
+
+    for (int step = 0; step <= nsteps; ++step)
+    {
+        if (step > 0) {
+            Move(pc_neighbor, step);
+            Move(pc_global, step);
+        }
+
+        // The flag is shared by all the containers of a type.
+        MyParticleContainer::neighbor_redistribute = true;
+        pc_neighbor.Redistribute();
+        MyParticleContainer::neighbor_redistribute = false;
+        pc_global.Redistribute();
+
+        long nbad = 0;
+        bool same = true;
+        long np[nlevs];
+        for (int lev = 0; lev < nlevs; ++lev) {
+            const Array<long> a = GridSums(pc_neighbor, lev, nbad);
+            const Array<long> b = GridSums(pc_global, lev, nbad);
+            same = same && (a == b);
+            np[lev] = 0;
+            for (int i = 0; i < a.size(); i += 3) np[lev] += a[i];
+        }
+        ParallelDescriptor::ReduceLongSum(nbad);
+        const bool ok = pc_neighbor.OK() && pc_global.OK();
+
+        amrex::Print() << "step " << step << ": " << np[0] << " and " << np[1]
+                       << " particles on the levels, "
+                       << (same ? "same grids" : "DIFFERENT grids") << ", "
+                       << nbad << " with wrong attributes, "
+                       << (ok ? "OK" : "NOT OK") << "\n";
+
+        if (!same || nbad != 0 || !ok) ++nfail;
+    }
+
+    const long ntotal = pc_neighbor.TotalNumberOfParticles();
+    if (ntotal != long(domain.numPts()*nppc)) {
+        amrex::Print() << "lost particles: " << ntotal << "\n";
+        ++nfail;
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,262 @@
+//
+// A test of the box and sphere queries of ParticleContainer after the
+// particles have moved.
+//
+//   mpirun -np 2 main.ex [n_cell=32] [max_grid_size=16] [nppc=2] [nqueries=20]
+//   mpirun -np 2 main.ex particles.do_cell_sort=1
+//
+// The particles are binned with SortParticlesByCell and queried.  Then they
+// are moved by up to a cell, either within their grids or freely, and
+// redistributed, and queried again.  Every query is checked against a scan
+// of all the particles.
+//
+
+#include <iostream>
+#include <cmath>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+typedef ParticleContainer<0> MyParticleContainer;
+typedef MyParticleContainer::ParticleType MyParticle;
+
+static
+void
+AddParticles (MyParticleContainer& pc, const Geometry& geom, int nppc)
+{
+    const BoxArray& ba = pc.ParticleBoxArray(0);
+    const DistributionMapping& dm = pc.ParticleDistributionMap(0);
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (int gid = 0; gid < ba.size(); ++gid)
+    {
+        if (dm[gid] != ParallelDescriptor::MyProc()) continue;
+        auto& ptile = pc.GetParticles()[0][std::make_pair(gid,0)];
+        const Box& bx = ba[gid];
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < nppc; ++n) {
+                MyParticle p;
+                p.id()  = MyParticle::NextID();
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + amrex::Random()) * dx[d];
+                }
+                ptile.push_back(p);
+            }
+        }
+    }
+}
+
+//
+// Move every particle by up to a cell in each direction.  Redistribute puts
+// those that leave the periodic domain back in.  With stay, the particles
+// are kept in their grids, so every tile keeps its number of particles.
+//
+static
+void
+MoveParticles (MyParticleContainer& pc, const Geometry& geom, bool stay)
+{
+    const BoxArray& ba = pc.ParticleBoxArray(0);
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (auto& kv : pc.GetParticles()[0])
+    {
+        const Box& bx = ba[kv.first.first];
+        for (auto& p : kv.second.GetArrayOfStructs()) {
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                p.pos(d) += (2.0*amrex::Random() - 1.0) * dx[d];
+                if (stay) {
+                    const Real lo = plo[d] + (bx.smallEnd(d) + 0.01) * dx[d];
+                    const Real hi = plo[d] + (bx.bigEnd(d) + 0.99) * dx[d];
+                    p.pos(d) = std::min(std::max(p.pos(d), lo), hi);
+                }
+            }
+        }
+    }
+}
+
+//
+// The number of particles and the sum of their ids in bx, or in the sphere,
+// by looking at every particle.
+//
+static
+void
+ScanBox (const MyParticleContainer& pc, const Geometry& geom, const Box& bx,
+         long& count, double& idsum)
+{
+    const Box& domain = geom.Domain();
+    count = 0;
+    idsum = 0.0;
+    for (const auto& kv : pc.GetParticles()[0])
+    {
+        for (const auto& p : kv.second.GetArrayOfStructs()) {
+            const IntVect iv = pc.Index(p, 0);
+            bool in = true;
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                // The image of the cell that is at or above the box's low end.
+                const int L = domain.length(d);
+                const int c = bx.smallEnd(d) + ((iv[d] - bx.smallEnd(d)) % L + L) % L;
+                if (c > bx.bigEnd(d)) in = false;
+            }
+            if (in) {
+                ++count;
+                idsum += p.id();
+            }
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(count);
+    ParallelDescriptor::ReduceRealSum(idsum);
+}
+
+static
+void
+ScanSphere (const MyParticleContainer& pc, const Geometry& geom, const Real* center, Real radius,
+            long& count, double& idsum)
+{
+    count = 0;
+    idsum = 0.0;
+    for (const auto& kv : pc.GetParticles()[0])
+    {
+        for (const auto& p : kv.second.GetArrayOfStructs()) {
+            Real r2 = 0.0;
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                const Real L = geom.ProbLength(d);
+                Real x = p.pos(d) - center[d];
+                x -= L * std::floor(x/L + 0.5);
+                r2 += x*x;
+            }
+            if (r2 <= radius*radius) {
+                ++count;
+                idsum += p.id();
+            }
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(count);
+    ParallelDescriptor::ReduceRealSum(idsum);
+}
+
+static
+double
+IdSum (const Array<MyParticle>& particles)
+{
+    double s = 0.0;
+    for (const auto& p : particles) {
+        s += p.id();
+    }
+    return s;
+}
+
+//
+// Returns the number of queries that do not agree with the scans.
+//
+static
+int
+CheckQueries (const MyParticleContainer& pc, const Geometry& geom, int nqueries)
+{
+    const Box& domain = geom.Domain();
+    int nbad = 0;
+
+    for (int q = 0; q < nqueries; ++q)
+    {
+        //
+        // The same queries on all processes: a box that may stick out of the
+        // domain, and a sphere that may cross the periodic boundaries.
+        //
+        IntVect lo, hi;
+        Real center[BL_SPACEDIM];
+        for (int d = 0; d < BL_SPACEDIM; ++d) {
+            lo[d] = int(amrex::Random_int(domain.length(d))) - domain.length(d)/4;
+            hi[d] = lo[d] + int(amrex::Random_int(domain.length(d)/2));
+            center[d] = geom.ProbLo(d) + amrex::Random() * geom.ProbLength(d);
+        }
+        ParallelDescriptor::Bcast(lo.getVect(), BL_SPACEDIM);
+        ParallelDescriptor::Bcast(hi.getVect(), BL_SPACEDIM);
+        ParallelDescriptor::Bcast(center, BL_SPACEDIM);
+        const Box bx(lo, hi);
+        const Real radius = 0.05 + 0.02*q;
+
+        long count;
+        double idsum;
+        Array<MyParticle> found;
+
+        ScanBox(pc, geom, bx, count, idsum);
+        pc.GetParticlesInBox(bx, 0, found);
+        if (pc.NumParticlesInBox(bx, 0) != count || long(found.size()) != count || IdSum(found) != idsum) {
+            amrex::Print() << "box " << bx << ": " << found.size() << " particles found, "
+                           << count << " in it\n";
+            ++nbad;
+        }
+
+        ScanSphere(pc, geom, center, radius, count, idsum);
+        pc.GetParticlesInSphere(center, radius, 0, found);
+        if (pc.NumParticlesInSphere(center, radius, 0) != count || long(found.size()) != count || IdSum(found) != idsum) {
+            amrex::Print() << "sphere of radius " << radius << ": " << found.size() << " particles found, "
+                           << count << " in it\n";
+            ++nbad;
+        }
+    }
+    return nbad;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell = 32;
+    int max_grid_size = 16;
+    int nppc = 2;
+    int nqueries = 20;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nppc", nppc);
+        pp.query("nqueries", nqueries);
+    }
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++) {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dmap(ba);
+
+    MyParticleContainer pc(geom, dmap, ba);
+
+    AddParticles(pc, geom, nppc);
+    pc.SortParticlesByCell();
+
+    int nfail = 0;
+
+    int nbad = CheckQueries(pc, geom, nqueries);
+    amrex::Print() << "sorted:                     " << nbad << " bad queries\n";
+    if (nbad != 0) ++nfail;
+
+    for (int step = 0; step < 4; ++step)
+    {
+        const bool stay = (step % 2 == 0);
+        MoveParticles(pc, geom, stay);
+        pc.Redistribute();
+        nbad = CheckQueries(pc, geom, nqueries);
+        amrex::Print() << "after move " << step << (stay ? " in the grids: " : ":              ")
+                       << nbad << " bad queries\n";
+        if (nbad != 0) ++nfail;
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,393 @@
+//
+// A test of the gather, kick, push and periodic kernels of
+// AMReX_ParticleKernels.H against the array of structs path.
+//
+//   mpirun -np 2 main.ex [n_cell=32] [max_grid_size=16] [nppc=2] [nsteps=4] [nqueries=20]
+//
+// Two containers are given the same particles, with masses and velocities
+// in the structs and room for the acceleration in the struct of arrays, in
+// a periodic domain.  Every step, one calls moveKick, moves the particles
+// in a loop over the structs and calls Redistribute, which puts them back
+// in the domain.  The other converts each tile with ParticlesToSoA and
+// calls SoAGatherCIC, SoAKick, SoAPushPositions and SoAEnforcePeriodic
+// before SoAToParticles and Redistribute.
+//
+//   - The CIC gather must agree with Particle::GetGravity, and the TSC
+//     gather with a cell by cell evaluation of the TSC weight function.
+//   - After every step, the particles of the two containers must have the
+//     same positions and velocities to round-off.
+//   - At the end, the box and sphere queries must find the same particles
+//     in both.
+//
+
+#include <iostream>
+#include <cmath>
+#include <map>
+#include <utility>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleKernels.H>
+#include <AMReX_Utility.H>
+
+using namespace amrex;
+
+//
+// The structs hold the mass and the velocity, the struct of arrays the
+// acceleration.  As SoAParticles, the mass is component 0, the velocity
+// starts at VelComp and the acceleration at AccComp.
+//
+typedef ParticleContainer<1+BL_SPACEDIM, 0, BL_SPACEDIM, 0> MyParticleContainer;
+typedef MyParticleContainer::ParticleType MyParticle;
+typedef SoAParticles<1+2*BL_SPACEDIM, 0> MySoA;
+
+static const int VelComp = 1;
+static const int AccComp = 1 + BL_SPACEDIM;
+
+//
+// A number in [0,1) that depends on a, b and c only.
+//
+static
+Real
+Hash (long a, long b, long c)
+{
+    unsigned long h = 14695981039346656037UL;
+    for (unsigned long v : {(unsigned long) a, (unsigned long) b, (unsigned long) c}) {
+        h ^= v;
+        h *= 1099511628211UL;
+        h ^= h >> 29;
+    }
+    return Real(h >> 11) / Real(1UL << 53);
+}
+
+static
+void
+AddParticles (MyParticleContainer& pc, int nppc)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Box& domain = geom.Domain();
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& ptile = pc.GetParticles()[0][std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+        const Box& bx = mfi.tilebox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < nppc; ++n) {
+                MyParticle p;
+                p.id()  = 1 + domain.index(iv)*nppc + n;
+                p.cpu() = ParallelDescriptor::MyProc();
+                p.rdata(0) = 1.0;
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + Hash(p.id(), d, -1)) * dx[d];
+                    p.rdata(VelComp+d) = 2.0*Hash(p.id(), d, -2) - 1.0;
+                }
+                ptile.push_back(p);
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    ptile.push_back_real(d, 0.0);
+                }
+            }
+        }
+    }
+}
+
+//
+// The TSC weight of a particle at len (in units of the cell size from
+// the lower corner of the domain) for the cell i.
+//
+static
+Real
+TSCWeight (Real len, int i)
+{
+    const Real x = std::abs(len - (i + 0.5));
+    if (x < 0.5) return 0.75 - x*x;
+    if (x < 1.5) return 0.5*(1.5 - x)*(1.5 - x);
+    return 0.0;
+}
+
+//
+// The largest difference between the gathered acceleration of the SoA
+// particles and that of the structs path, with CIC, and with TSC against
+// the weight function.
+//
+static
+void
+CheckGather (const MySoA& soa, const ArrayOfStructs<1+BL_SPACEDIM,0>& aos, const FArrayBox& fab,
+             const Geometry& geom, Real& cic_err, Real& tsc_err)
+{
+    const Real* plo = geom.ProbLo();
+    const Real* dx = geom.CellSize();
+    Real dxi[BL_SPACEDIM];
+    for (int d = 0; d < BL_SPACEDIM; ++d) dxi[d] = 1.0 / dx[d];
+
+    MySoA tsc = soa;
+    SoAGatherTSC<AccComp, BL_SPACEDIM>(tsc, fab, 0, plo, dxi);
+
+    for (int i = 0; i < aos.numParticles(); ++i)
+    {
+        const auto& p = aos[i];
+
+        Real grav[BL_SPACEDIM];
+        MyParticle::GetGravity(fab, geom, p, grav);
+
+        Real len[BL_SPACEDIM];
+        IntVect iv;
+        for (int d = 0; d < BL_SPACEDIM; ++d) {
+            len[d] = (p.pos(d) - plo[d]) / dx[d];
+            iv[d]  = static_cast<int>(std::floor(len[d]));
+        }
+        Real ref[BL_SPACEDIM] = { AMREX_D_DECL(0.0, 0.0, 0.0) };
+        const Box sbx(iv - 1, iv + 1);
+        for (IntVect c = sbx.smallEnd(); c <= sbx.bigEnd(); sbx.next(c)) {
+            Real w = 1.0;
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                w *= TSCWeight(len[d], c[d]);
+            }
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                ref[d] += w * fab(c, d);
+            }
+        }
+
+        for (int d = 0; d < BL_SPACEDIM; ++d) {
+            cic_err = std::max(cic_err, std::abs(soa.rdata[AccComp+d][i] - grav[d]));
+            tsc_err = std::max(tsc_err, std::abs(tsc.rdata[AccComp+d][i] - ref[d]));
+        }
+    }
+}
+
+//
+// One step of the structs path: half a kick, a push, and Redistribute.
+//
+static
+void
+StepAoS (MyParticleContainer& pc, MultiFab& acc, Real dt)
+{
+    pc.moveKick(acc, 0, dt, 1.0, 1.0, 0);
+    for (auto& kv : pc.GetParticles(0)) {
+        for (auto& p : kv.second.GetArrayOfStructs()) {
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                p.pos(d) += dt * p.rdata(VelComp+d);
+            }
+        }
+    }
+    pc.Redistribute();
+}
+
+//
+// The same step with the SoA kernels.  Returns the largest gather errors.
+//
+static
+void
+StepSoA (MyParticleContainer& pc, const MultiFab& acc, Real dt, Real& cic_err, Real& tsc_err)
+{
+    const Geometry& geom = pc.Geom(0);
+    Real dxi[BL_SPACEDIM];
+    for (int d = 0; d < BL_SPACEDIM; ++d) dxi[d] = 1.0 / geom.CellSize(d);
+
+    for (auto& kv : pc.GetParticles(0))
+    {
+        const FArrayBox& fab = acc[kv.first.first];
+        MySoA soa;
+        ParticlesToSoA(kv.second, soa);
+        SoAGatherCIC<AccComp, BL_SPACEDIM>(soa, fab, 0, geom.ProbLo(), dxi);
+        CheckGather(soa, kv.second.GetArrayOfStructs(), fab, geom, cic_err, tsc_err);
+        SoAKick<VelComp, AccComp>(soa, 0.5*dt);
+        SoAPushPositions<VelComp>(soa, dt);
+        SoAEnforcePeriodic(soa, geom);
+        SoAToParticles(soa, kv.second);
+    }
+    pc.Redistribute();
+}
+
+//
+// The largest difference in position and velocity between the particles of
+// a and b with the same id, or a huge number if they do not have the same
+// particles, over all processes.
+//
+static
+Real
+Compare (const MyParticleContainer& a, const MyParticleContainer& b)
+{
+    std::map<int, const MyParticle*> pa;
+    long na = 0, nb = 0;
+    for (const auto& kv : a.GetParticles(0)) {
+        for (const auto& p : kv.second.GetArrayOfStructs()) {
+            pa[p.id()] = &p;
+            ++na;
+        }
+    }
+    Real err = 0.0;
+    for (const auto& kv : b.GetParticles(0)) {
+        for (const auto& p : kv.second.GetArrayOfStructs()) {
+            ++nb;
+            auto it = pa.find(p.id());
+            if (it == pa.end()) {
+                err = 1.e200;
+                continue;
+            }
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                err = std::max(err, std::abs(p.pos(d) - it->second->pos(d)));
+                err = std::max(err, std::abs(p.rdata(VelComp+d) - it->second->rdata(VelComp+d)));
+            }
+        }
+    }
+    if (na != nb) err = 1.e200;
+    ParallelDescriptor::ReduceRealMax(err);
+    return err;
+}
+
+static
+double
+IdSum (const Array<MyParticle>& particles)
+{
+    double s = 0.0;
+    for (const auto& p : particles) {
+        s += p.id();
+    }
+    return s;
+}
+
+//
+// The number of box and sphere queries that do not find the same particles
+// in a and b.
+//
+static
+int
+CompareQueries (const MyParticleContainer& a, const MyParticleContainer& b,
+                const Geometry& geom, int nqueries)
+{
+    const Box& domain = geom.Domain();
+    int nbad = 0;
+
+    for (int q = 0; q < nqueries; ++q)
+    {
+        IntVect lo, hi;
+        Real center[BL_SPACEDIM];
+        for (int d = 0; d < BL_SPACEDIM; ++d) {
+            lo[d] = int(amrex::Random_int(domain.length(d))) - domain.length(d)/4;
+            hi[d] = lo[d] + int(amrex::Random_int(domain.length(d)/2));
+            center[d] = geom.ProbLo(d) + amrex::Random() * geom.ProbLength(d);
+        }
+        ParallelDescriptor::Bcast(lo.getVect(), BL_SPACEDIM);
+        ParallelDescriptor::Bcast(hi.getVect(), BL_SPACEDIM);
+        ParallelDescriptor::Bcast(center, BL_SPACEDIM);
+        const Box bx(lo, hi);
+        const Real radius = 0.05 + 0.02*q;
+
+        Array<MyParticle> found_a, found_b;
+
+        a.GetParticlesInBox(bx, 0, found_a);
+        b.GetParticlesInBox(bx, 0, found_b);
+        if (a.NumParticlesInBox(bx, 0) != b.NumParticlesInBox(bx, 0) ||
+            found_a.size() != found_b.size() || IdSum(found_a) != IdSum(found_b))
+        {
+            amrex::Print() << "box " << bx << ": " << found_a.size() << " and "
+                           << found_b.size() << " particles found\n";
+            ++nbad;
+        }
+
+        a.GetParticlesInSphere(center, radius, 0, found_a);
+        b.GetParticlesInSphere(center, radius, 0, found_b);
+        if (a.NumParticlesInSphere(center, radius, 0) != b.NumParticlesInSphere(center, radius, 0) ||
+            found_a.size() != found_b.size() || IdSum(found_a) != IdSum(found_b))
+        {
+            amrex::Print() << "sphere of radius " << radius << ": " << found_a.size() << " and "
+                           << found_b.size() << " particles found\n";
+            ++nbad;
+        }
+    }
+    return nbad;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell = 32;
+    int max_grid_size = 16;
+    int nppc = 2;
+    int nsteps = 4;
+    int nqueries = 20;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nppc", nppc);
+        pp.query("nsteps", nsteps);
+        pp.query("nqueries", nqueries);
+    }
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++) {
+        real_box.setLo(n, -0.5);
+        real_box.setHi(n, 0.5);
+    }
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+    const Real* dx = geom.CellSize();
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dmap(ba);
+
+    //
+    // A smooth periodic acceleration, with its ghost cells filled.
+    //
+    MultiFab acc(ba, dmap, BL_SPACEDIM, 1);
+    for (MFIter mfi(acc); mfi.isValid(); ++mfi) {
+        FArrayBox& fab = acc[mfi];
+        const Box& bx = mfi.validbox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                const Real x = geom.ProbLo(d) + (iv[d] + 0.5) * dx[d];
+                const Real y = geom.ProbLo((d+1)%BL_SPACEDIM) + (iv[(d+1)%BL_SPACEDIM] + 0.5) * dx[(d+1)%BL_SPACEDIM];
+                fab(iv, d) = std::sin(2.0*M_PI*(x + 0.3*d)) + 0.5*std::cos(2.0*M_PI*y);
+            }
+        }
+    }
+    acc.FillBoundary(geom.periodicity());
+
+    MyParticleContainer pc_aos(geom, dmap, ba);
+    MyParticleContainer pc_soa(geom, dmap, ba);
+    AddParticles(pc_aos, nppc);
+    AddParticles(pc_soa, nppc);
+    pc_aos.Redistribute();
+    pc_soa.Redistribute();
+
+    //
+    // Particles move up to about half a cell a step, so some cross the
+    // periodic boundaries.
+    //
+    const Real dt = 0.4 * dx[0];
+
+    int nfail = 0;
+
+    for (int step = 1; step <= nsteps; ++step)
+    {
+        Real cic_err = 0.0, tsc_err = 0.0;
+        StepAoS(pc_aos, acc, dt);
+        StepSoA(pc_soa, acc, dt, cic_err, tsc_err);
+        ParallelDescriptor::ReduceRealMax(cic_err);
+        ParallelDescriptor::ReduceRealMax(tsc_err);
+
+        const Real err = Compare(pc_aos, pc_soa);
+
+        amrex::Print() << "step " << step << ": CIC gather error " << cic_err
+                       << ", TSC gather error " << tsc_err
+                       << ", largest difference to the structs path " << err << "\n";
+
+        if (cic_err > 1.e-13 || tsc_err > 1.e-13 || err > 1.e-13) ++nfail;
+    }
+
+    const int nbad = CompareQueries(pc_aos, pc_soa, geom, nqueries);
+    amrex::Print() << nbad << " queries that differ\n";
+    if (nbad != 0) ++nfail;
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,258 @@
+//
+// A test of the Verlet neighbor lists of NeighborParticleContainer.
+//
+//   mpirun -np 4 main.ex [n_cell=16] [max_grid_size=8] [nppc=4] [nsteps=12]
+//
+// Two containers are given the same particles and the same small moves in
+// a periodic domain.  One keeps a Verlet list with updateNeighborList,
+// the other builds its neighbor list from scratch every step.  The pairs
+// are particles of the same id parity within a cutoff, so check_pair is
+// not a plain distance test and the Verlet list must use the overload
+// with the skin.  After every step, the pairs of the Verlet list within
+// the cutoff must be the pairs of the rebuilt list.  Steps where the list
+// is reused and steps where it is rebuilt must both happen.
+//
+
+#include <iostream>
+#include <utility>
+#include <cstring>
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_NeighborParticles.H>
+
+using namespace amrex;
+
+//
+// rdata(0) holds the id, so that the neighbor copies have it too.
+//
+class PairContainer
+    : public NeighborParticleContainer<1, 0, 1>
+{
+public:
+
+    PairContainer (const Geometry& geom, const DistributionMapping& dmap,
+                   const BoxArray& ba, Real a_cutoff)
+        : NeighborParticleContainer<1, 0, 1>(geom, dmap, ba, 1),
+          cutoff(a_cutoff)
+        {}
+
+    static Real Distance2 (const ParticleType& p1, const ParticleType& p2) {
+        return AMREX_D_TERM(  (p1.pos(0) - p2.pos(0))*(p1.pos(0) - p2.pos(0)),
+                            + (p1.pos(1) - p2.pos(1))*(p1.pos(1) - p2.pos(1)),
+                            + (p1.pos(2) - p2.pos(2))*(p1.pos(2) - p2.pos(2)) );
+    }
+
+    static bool SameParity (const ParticleType& p1, const ParticleType& p2) {
+        return (long(p1.rdata(0)) - long(p2.rdata(0))) % 2 == 0;
+    }
+
+    const Real cutoff;
+
+protected:
+
+    virtual bool check_pair (const ParticleType& p1, const ParticleType& p2) override {
+        return SameParity(p1, p2) && Distance2(p1, p2) <= cutoff*cutoff;
+    }
+
+    virtual bool check_pair (const ParticleType& p1, const ParticleType& p2, Real skin) override {
+        return SameParity(p1, p2) && Distance2(p1, p2) <= (cutoff+skin)*(cutoff+skin);
+    }
+};
+
+//
+// A number in [0,1) that depends on a, b and c only.
+//
+static
+Real
+Hash (long a, long b, long c)
+{
+    unsigned long h = 14695981039346656037UL;
+    for (unsigned long v : {(unsigned long) a, (unsigned long) b, (unsigned long) c}) {
+        h ^= v;
+        h *= 1099511628211UL;
+        h ^= h >> 29;
+    }
+    return Real(h >> 11) / Real(1UL << 53);
+}
+
+static
+void
+AddParticles (PairContainer& pc, int nppc)
+{
+    const Geometry& geom = pc.Geom(0);
+    const Box& domain = geom.Domain();
+    const Real* dx = geom.CellSize();
+    const Real* plo = geom.ProbLo();
+
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& ptile = pc.GetParticles()[0][std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+        const Box& bx = mfi.tilebox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < nppc; ++n) {
+                PairContainer::ParticleType p;
+                p.id()  = 1 + domain.index(iv)*nppc + n;
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + Hash(p.id(), d, -1)) * dx[d];
+                }
+                p.rdata(0) = p.id();
+                ptile.push_back(p);
+            }
+        }
+    }
+}
+
+//
+// Move every particle by up to 0.05 cells in each direction.
+//
+static
+void
+Move (PairContainer& pc, int step)
+{
+    const Real* dx = pc.Geom(0).CellSize();
+    for (auto& kv : pc.GetParticles(0))
+    {
+        auto& aos = kv.second.GetArrayOfStructs();
+        for (int i = 0; i < aos.numParticles(); ++i) {
+            auto& p = aos[i];
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                p.pos(d) += 0.1*(Hash(p.id(), step, d) - 0.5)*dx[d];
+            }
+        }
+    }
+}
+
+//
+// The number of pairs in the neighbor lists within the cutoff, and a sum
+// of a hash of their ids, over all processes.
+//
+static
+std::pair<long,long>
+Pairs (PairContainer& pc)
+{
+    typedef PairContainer::ParticleType ParticleType;
+
+    long npairs = 0;
+    unsigned long hsum = 0;
+    for (PairContainer::MyParIter pti(pc, 0); pti.isValid(); ++pti)
+    {
+        const PairContainer::PairIndex index(pti.index(), pti.LocalTileIndex());
+        const auto& aos = pti.GetArrayOfStructs();
+        const Array<char>& nbuf = pc.neighbors[index];
+        const Array<int>& nl = pc.neighbor_list[index];
+        const int np = aos.numParticles();
+        const int nn = nbuf.size() / pc.pdata_size;
+
+        Array<ParticleType> all(np + nn);
+        for (int i = 0; i < np; ++i) all[i] = aos[i];
+        for (int i = 0; i < nn; ++i) {
+            std::memcpy(&all[np+i], nbuf.dataPtr() + i*pc.pdata_size, pc.pdata_size);
+        }
+
+        int k = 0;
+        for (int i = 0; i < np; ++i) {
+            const int nnb = nl[k];
+            for (int m = 1; m <= nnb; ++m) {
+                const ParticleType& q = all[nl[k+m]-1];
+                if (PairContainer::Distance2(all[i], q) <= pc.cutoff*pc.cutoff) {
+                    ++npairs;
+                    unsigned long h = long(all[i].rdata(0))*1000003UL + long(q.rdata(0));
+                    h *= 0x9E3779B97F4A7C15UL;
+                    hsum += h ^ (h >> 31);
+                }
+            }
+            k += nnb + 1;
+        }
+    }
+
+    long h = long(hsum);
+    ParallelDescriptor::ReduceLongSum(npairs);
+    ParallelDescriptor::ReduceLongSum(h);
+    return std::make_pair(npairs, h);
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int n_cell = 16;
+    int max_grid_size = 8;
+    int nppc = 4;
+    int nsteps = 12;
+    {
+        ParmParse pp;
+        pp.query("n_cell", n_cell);
+        pp.query("max_grid_size", max_grid_size);
+        pp.query("nppc", nppc);
+        pp.query("nsteps", nsteps);
+    }
+
+    RealBox real_box;
+    for (int n = 0; n < BL_SPACEDIM; n++) {
+        real_box.setLo(n, 0.0);
+        real_box.setHi(n, 1.0);
+    }
+    const Box domain(IntVect::TheZeroVector(), IntVect(AMREX_D_DECL(n_cell-1,n_cell-1,n_cell-1)));
+    int is_per[BL_SPACEDIM] = {AMREX_D_DECL(1,1,1)};
+    Geometry geom(domain, &real_box, CoordSys::cartesian, is_per);
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dmap(ba);
+
+    const Real dx = geom.CellSize(0);
+    const Real cutoff = 0.6*dx;
+    const Real skin   = 0.3*dx;
+
+    PairContainer pc_verlet (geom, dmap, ba, cutoff);
+    PairContainer pc_rebuilt(geom, dmap, ba, cutoff);
+    AddParticles(pc_verlet, nppc);
+    AddParticles(pc_rebuilt, nppc);
+    pc_verlet.Redistribute();
+    pc_rebuilt.Redistribute();
+
+    pc_verlet.setVerletList(cutoff, skin);
+
+    const int lev = 0;
+    int nfail = 0, nreused = 0, nrebuilt = 0;
+
+    for (int step = 0; step <= nsteps; ++step)
+    {
+        if (step > 0) {
+            Move(pc_verlet, step);
+            Move(pc_rebuilt, step);
+            pc_rebuilt.Redistribute();
+        }
+
+        const bool rebuild = pc_verlet.needsNeighborListRebuild(lev);
+        if (rebuild) ++nrebuilt; else ++nreused;
+        pc_verlet.updateNeighborList(lev, true);
+
+        pc_rebuilt.fillNeighbors(lev);
+        pc_rebuilt.buildNeighborList(lev, true);
+
+        const std::pair<long,long> a = Pairs(pc_verlet);
+        const std::pair<long,long> b = Pairs(pc_rebuilt);
+
+        pc_rebuilt.clearNeighbors(lev);
+
+        amrex::Print() << "step " << step << (rebuild ? " (rebuilt)" : " (reused) ")
+                       << ": " << a.first << " pairs in the Verlet list, "
+                       << b.first << " in the rebuilt one"
+                       << (a == b ? "" : ", DIFFERENT") << "\n";
+
+        if (a != b || a.first == 0) ++nfail;
+    }
+
+    if (nreused == 0 || nrebuilt == 0) {
+        amrex::Print() << "the list was " << (nreused == 0 ? "never reused" : "never rebuilt") << "\n";
+        ++nfail;
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -0,0 +1,421 @@
+//
+// A test of the AmrLevel::FillPatch that fills a level from the old one on
+// regrid.
+//
+//   mpirun -np 4 main.ex inputs [nsteps=6]
+//
+// A slab that stays put, a ball that moves and a ball that jumps are
+// tagged, so on every regrid some grids survive, some move and some are
+// new.  The run is done with amr.regrid_remap=0 and 1.  Each new level is
+// filled from the old one with FillPatch, which takes the grids that
+// survive on the same process straight from the old data, and with a
+// FillPatchIterator on all the grids, and the two must be the same bit for
+// bit.  After every step, when the levels have old and new data, grids
+// some of which are moved are filled between the two times both ways as
+// well.
+//
+
+#include <iostream>
+#include <cmath>
+
+#include <AMReX.H>
+#include <AMReX_Amr.H>
+#include <AMReX_AmrLevel.H>
+#include <AMReX_LevelBld.H>
+#include <AMReX_Interpolater.H>
+#include <AMReX_PROB_AMR_F.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+enum StateType { A_Type = 0, B_Type, NUM_STATE_TYPE };
+
+static const int NUM_A = 2;
+static const int NUM_B = 1;
+
+//
+// What the regrids have seen: new grids that are old grids, those of them
+// on the same process, grids that overlap old ones, and grids that do not.
+//
+static long nsurvived = 0, nsame_proc = 0, nmoved = 0, nnew = 0;
+
+static int nfail = 0;
+
+//
+// A smooth function of the cell center and the time, different for each
+// component.
+//
+static
+Real
+Value (const Real* x, Real time, int comp)
+{
+    return AMREX_D_TERM(std::sin(6.0*x[0] + comp), + std::cos(4.0*x[1] - comp), + x[2]*x[2])
+        + comp + 5.0*time;
+}
+
+//
+// The number of values in the valid regions of a and b that differ, over
+// all processes.
+//
+static
+long
+NumDiff (const MultiFab& a, const MultiFab& b)
+{
+    BL_ASSERT(a.boxArray() == b.boxArray());
+    BL_ASSERT(a.DistributionMap() == b.DistributionMap());
+
+    long ndiff = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const FArrayBox& fa = a[mfi];
+        const FArrayBox& fb = b[mfi];
+        for (int n = 0; n < a.nComp(); ++n) {
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                if (fa(iv,n) != fb(iv,n)) ++ndiff;
+            }
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(ndiff);
+    return ndiff;
+}
+
+//
+// Fill dst from amrlevel with FillPatch and compare it with a
+// FillPatchIterator on the same grids.  Returns the number of values that
+// differ.
+//
+static
+long
+CompareFill (AmrLevel& amrlevel, MultiFab& dst, Real time, int idx)
+{
+    const int ncomp = dst.nComp();
+    AmrLevel::FillPatch(amrlevel, dst, 0, time, idx, 0, ncomp);
+
+    MultiFab ref(dst.boxArray(), dst.DistributionMap(), ncomp, 0);
+    FillPatchIterator fpi(amrlevel, ref, 0, time, idx, 0, ncomp);
+    MultiFab::Copy(ref, fpi.get_mf(), 0, 0, ncomp, 0);
+
+    return NumDiff(dst, ref);
+}
+
+extern "C"
+void
+testfill (Real* data, const int* lo, const int* hi,
+          const int* dom_lo, const int* dom_hi, const Real* dx, const Real* grd_lo,
+          const Real* time, const int* bc)
+{
+    const long nx = hi[0] - lo[0] + 1;
+    const long ny = hi[1] - lo[1] + 1;
+
+    for (int k = lo[2]; k <= hi[2]; ++k) {
+        for (int j = lo[1]; j <= hi[1]; ++j) {
+            for (int i = lo[0]; i <= hi[0]; ++i) {
+                const int iv[3] = {i, j, k};
+                bool outside = false;
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    if (bc[d] == EXT_DIR && iv[d] < dom_lo[d]) outside = true;
+                    if (bc[BL_SPACEDIM+d] == EXT_DIR && iv[d] > dom_hi[d]) outside = true;
+                }
+                if (outside) {
+                    data[(i-lo[0]) + nx*((j-lo[1]) + ny*(k-lo[2]))] = 10.0 + 0.01*(i + 2*j + 3*k);
+                }
+            }
+        }
+    }
+}
+
+extern "C"
+void
+amrex_probinit (const int* init, const int* name, const int* namelen,
+                const amrex_real* problo, const amrex_real* probhi)
+{}
+
+class TestLevel
+    : public AmrLevel
+{
+public:
+
+    TestLevel () {}
+
+    TestLevel (Amr& papa, int lev, const Geometry& level_geom, const BoxArray& bl,
+               const DistributionMapping& dm, Real time)
+        : AmrLevel(papa, lev, level_geom, bl, dm, time) {}
+
+    static void variableSetUp ();
+
+    static void variableCleanUp () { desc_lst.clear(); }
+
+    virtual void computeInitialDt (int finest_level, int sub_cycle, Array<int>& n_cycle,
+                                   const Array<IntVect>& ref_ratio, Array<Real>& dt_level,
+                                   Real stop_time) override
+    {
+        Real dt = 0.02;
+        for (int i = 0; i <= finest_level; ++i) {
+            dt_level[i] = dt;
+            if (i < finest_level) dt /= ref_ratio[i][0];
+        }
+    }
+
+    virtual void computeNewDt (int finest_level, int sub_cycle, Array<int>& n_cycle,
+                               const Array<IntVect>& ref_ratio, Array<Real>& dt_min,
+                               Array<Real>& dt_level, Real stop_time,
+                               int post_regrid_flag) override {}
+
+    virtual Real advance (Real time, Real dt, int iteration, int ncycle) override
+    {
+        for (int idx = 0; idx < NUM_STATE_TYPE; ++idx) {
+            state[idx].allocOldData();
+            state[idx].swapTimeLevels(dt);
+        }
+        SetData(time + dt);
+        return dt;
+    }
+
+    virtual void post_timestep (int iteration) override {}
+
+    virtual void post_regrid (int lbase, int new_finest) override {}
+
+    virtual void post_init (Real stop_time) override {}
+
+    virtual void initData () override
+    {
+        SetData(get_state_data(A_Type).curTime());
+    }
+
+    virtual void init (AmrLevel& old) override
+    {
+        const Real cur_time = old.get_state_data(A_Type).curTime();
+        setTimeLevel(cur_time, 0.0, parent->dtLevel(level));
+
+        const BoxArray& old_ba = old.boxArray();
+        const DistributionMapping& old_dm = old.DistributionMap();
+        std::vector< std::pair<int,Box> > isects;
+        for (int i = 0; i < grids.size(); ++i) {
+            old_ba.intersections(grids[i], isects);
+            if (isects.empty()) {
+                ++nnew;
+            } else if (isects.size() == 1 && isects[0].second == grids[i]
+                       && old_ba[isects[0].first] == grids[i]) {
+                ++nsurvived;
+                if (old_dm[isects[0].first] == dmap[i]) ++nsame_proc;
+            } else {
+                ++nmoved;
+            }
+        }
+
+        for (int idx = 0; idx < NUM_STATE_TYPE; ++idx) {
+            const long ndiff = CompareFill(old, get_new_data(idx), cur_time, idx);
+            if (ndiff != 0) {
+                amrex::Print() << "regrid of level " << level << ", state " << idx << ": "
+                               << ndiff << " values differ\n";
+                ++nfail;
+            }
+        }
+    }
+
+    virtual void init () override
+    {
+        const Real cur_time = parent->getLevel(level-1).get_state_data(A_Type).curTime();
+        setTimeLevel(cur_time, 0.0, parent->dtLevel(level));
+
+        for (int idx = 0; idx < NUM_STATE_TYPE; ++idx) {
+            MultiFab& S_new = get_new_data(idx);
+            FillCoarsePatch(S_new, 0, cur_time, idx, 0, S_new.nComp());
+        }
+    }
+    //
+    // Tag a slab that stays put, a ball that moves in x and a small ball
+    // that jumps between two places every coarse step.
+    //
+    virtual void errorEst (TagBoxArray& tags, int clearval, int tagval, Real time,
+                           int n_error_buf, int ngrow) override
+    {
+        const Real* dx = geom.CellSize();
+        const Real center[3] = {0.25 + 2.0*time, 0.4, 0.4};
+        const int  coarse_step = static_cast<int>(std::floor(time/0.02 + 1.e-6));
+        const Real center2[3] = {0.5, (coarse_step % 2 == 0) ? 0.15 : 0.85, 0.75};
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            TagBox& tagfab = tags[mfi];
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                Real r2 = 0.0, r2_small = 0.0;
+                Real x[BL_SPACEDIM];
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    x[d] = geom.ProbLo(d) + (iv[d] + 0.5) * dx[d];
+                    r2 += (x[d] - center[d]) * (x[d] - center[d]);
+                    r2_small += (x[d] - center2[d]) * (x[d] - center2[d]);
+                }
+                const bool ball = r2 < 0.12*0.12 || r2_small < 0.06*0.06;
+                const bool slab = std::abs(x[0] - 0.8) < 0.06 && x[1] < 0.5;
+                if (ball || slab) {
+                    tagfab(iv) = tagval;
+                }
+            }
+        }
+    }
+
+private:
+
+    void SetData (Real time)
+    {
+        const Real* dx = geom.CellSize();
+        for (int idx = 0; idx < NUM_STATE_TYPE; ++idx)
+        {
+            MultiFab& S_new = get_new_data(idx);
+            for (MFIter mfi(S_new); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.validbox();
+                FArrayBox& fab = S_new[mfi];
+                for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+                    Real x[BL_SPACEDIM];
+                    for (int d = 0; d < BL_SPACEDIM; ++d) {
+                        x[d] = geom.ProbLo(d) + (iv[d] + 0.5) * dx[d];
+                    }
+                    for (int n = 0; n < S_new.nComp(); ++n) {
+                        fab(iv,n) = Value(x, time, n + NUM_A*idx);
+                    }
+                }
+            }
+        }
+    }
+};
+
+void
+TestLevel::variableSetUp ()
+{
+    BL_ASSERT(desc_lst.size() == 0);
+
+    int lo_bc[BL_SPACEDIM];
+    int hi_bc[BL_SPACEDIM];
+    for (int d = 0; d < BL_SPACEDIM; ++d) {
+        lo_bc[d] = hi_bc[d] = Geometry::isPeriodic(d) ? INT_DIR : EXT_DIR;
+    }
+    BCRec bc(lo_bc, hi_bc);
+
+    desc_lst.addDescriptor(A_Type, IndexType::TheCellType(), StateDescriptor::Point,
+                           0, NUM_A, &cell_cons_interp);
+    desc_lst.setComponent(A_Type, 0, "a0", bc, StateDescriptor::BndryFunc(testfill));
+    desc_lst.setComponent(A_Type, 1, "a1", bc, StateDescriptor::BndryFunc(testfill), &pc_interp);
+
+    desc_lst.addDescriptor(B_Type, IndexType::TheCellType(), StateDescriptor::Point,
+                           0, NUM_B, &lincc_interp);
+    desc_lst.setComponent(B_Type, 0, "b0", bc, StateDescriptor::BndryFunc(testfill));
+}
+
+class TestLevelBld
+    : public LevelBld
+{
+    virtual void variableSetUp () override { TestLevel::variableSetUp(); }
+
+    virtual void variableCleanUp () override { TestLevel::variableCleanUp(); }
+
+    virtual AmrLevel* operator() () override { return new TestLevel; }
+
+    virtual AmrLevel* operator() (Amr& papa, int lev, const Geometry& level_geom,
+                                  const BoxArray& ba, const DistributionMapping& dm,
+                                  Real time) override
+    {
+        return new TestLevel(papa, lev, level_geom, ba, dm, time);
+    }
+};
+
+TestLevelBld test_bld;
+
+LevelBld*
+getLevelBld ()
+{
+    return &test_bld;
+}
+
+//
+// Fill every fine level between its old and new times on its grids, every
+// other one moved by a few cells, on the processes that own them, with
+// FillPatch and with a FillPatchIterator.
+//
+static
+void
+CheckBetweenTimes (Amr& amr)
+{
+    for (int lev = 1; lev <= amr.finestLevel(); ++lev)
+    {
+        AmrLevel& amrlevel = amr.getLevel(lev);
+        const StateData& sd = amrlevel.get_state_data(A_Type);
+        const Real time = 0.5*(sd.prevTime() + sd.curTime());
+        const Box& domain = amrlevel.Geom().Domain();
+
+        BoxList bl;
+        for (int i = 0; i < amrlevel.boxArray().size(); ++i) {
+            Box bx = amrlevel.boxArray()[i];
+            if (i % 2 == 1) {
+                bx.shift(IntVect(AMREX_D_DECL(3,-2,1)));
+                bx &= domain;
+            }
+            bl.push_back(bx);
+        }
+        const BoxArray ba(bl);
+        const DistributionMapping& dm = amrlevel.DistributionMap();
+
+        for (int idx = 0; idx < NUM_STATE_TYPE; ++idx) {
+            MultiFab mf(ba, dm, amrlevel.get_new_data(idx).nComp(), 0);
+            const long ndiff = CompareFill(amrlevel, mf, time, idx);
+            if (ndiff != 0) {
+                amrex::Print() << "level " << lev << ", state " << idx << " at time " << time
+                               << ": " << ndiff << " values differ\n";
+                ++nfail;
+            }
+        }
+    }
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int nsteps = 6;
+    {
+        ParmParse pp;
+        pp.query("nsteps", nsteps);
+    }
+
+    for (int remap = 0; remap <= 1; ++remap)
+    {
+        {
+            ParmParse pp("amr");
+            pp.add("regrid_remap", remap);
+        }
+
+        nsurvived = nsame_proc = nmoved = nnew = 0;
+        const int nfail_before = nfail;
+
+        {
+            Amr amr;
+            amr.init(0.0, 1.0);
+
+            for (int step = 0; step < nsteps; ++step) {
+                amr.coarseTimeStep(1.0);
+                CheckBetweenTimes(amr);
+            }
+        }
+
+        amrex::Print() << "regrid_remap " << remap << ": " << nsurvived << " grids survived ("
+                       << nsame_proc << " on the same process), " << nmoved << " moved, "
+                       << nnew << " new, " << nfail - nfail_before << " failures\n";
+
+        if (nsurvived == 0 || nmoved == 0 || nnew == 0) {
+            amrex::Print() << "    the regrids did not keep, move and add grids\n";
+            ++nfail;
+        }
+        if (remap == 1 && nsame_proc == 0) {
+            amrex::Print() << "    no grid stayed on its process\n";
+            ++nfail;
+        }
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
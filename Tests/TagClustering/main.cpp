@@ -0,0 +1,280 @@
+//
+// A test of the clustering of compressed tags and of the distributed
+// clustering.
+//
+//   mpirun -np 4 main.ex inputs
+//
+// The same tags, a spherical shell and a thin slab, are clustered into
+// the grids of every level with amr.compress_tags=0 and 1, each with
+// and without amr.distributed_clustering.  Compressing the tags must not
+// change the grids, and every level must be properly nested in the one
+// below.
+//
+// The tags are also set on grown, coarsened grids that overlap, as
+// MakeNewGrids leaves them, and clustered with ClusterTagsDistributed and
+// from the gathered tags.  The distributed boxes must be disjoint, within
+// the proper nesting domain, cover every tag, and have an efficiency of
+// at least grid_eff, or no less than the worst gathered box.  They may
+// take no more than a quarter more cells than the gathered ones, and on
+// one process they must be the gathered boxes, some of them merged.
+//
+
+#include <iostream>
+#include <cmath>
+
+#include <AMReX.H>
+#include <AMReX_AmrCore.H>
+#include <AMReX_BoxDomain.H>
+#include <AMReX_Cluster.H>
+#include <AMReX_TagBox.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+//
+// Is the cell at x, of size dx, in the shell or the slab?
+//
+static
+bool
+Tagged (const Real* x, const Real* dx)
+{
+    Real r2 = 0.0;
+    for (int d = 0; d < BL_SPACEDIM; ++d) {
+        r2 += x[d]*x[d];
+    }
+    const bool shell = std::abs(std::sqrt(r2) - 0.3) < 1.5*dx[0];
+    const bool slab  = std::abs(x[0] - 0.2) < 0.05 && std::abs(x[BL_SPACEDIM-1] + 0.3) < 0.02;
+    return shell || slab;
+}
+
+class Mesh
+    : public AmrCore
+{
+public:
+
+    Mesh (bool compress, bool distributed)
+    {
+        compress_tags          = compress;
+        distributed_clustering = distributed;
+    }
+
+    virtual void MakeNewLevelFromScratch (int lev, Real time, const BoxArray& ba,
+                                          const DistributionMapping& dm) override {}
+    virtual void MakeNewLevelFromCoarse (int lev, Real time, const BoxArray& ba,
+                                         const DistributionMapping& dm) override {}
+    virtual void RemakeLevel (int lev, Real time, const BoxArray& ba,
+                              const DistributionMapping& dm) override {}
+    virtual void ClearLevel (int lev) override {}
+
+    virtual void ErrorEst (int lev, TagBoxArray& tags, Real time, int ngrow) override
+    {
+        const Geometry& gm = Geom(lev);
+        const Real* dx = gm.CellSize();
+
+        for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            TagBox& tagfab = tags[mfi];
+            for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+            {
+                Real x[BL_SPACEDIM];
+                for (int d = 0; d < BL_SPACEDIM; ++d) {
+                    x[d] = gm.ProbLo(d) + (iv[d] + 0.5) * dx[d] - 0.5;
+                }
+                if (Tagged(x, dx)) {
+                    tagfab(iv) = TagBox::SET;
+                }
+            }
+        }
+    }
+
+    //
+    // Cluster the tags with ClusterTagsDistributed, and from the gathered
+    // tags the way MakeNewGrids does without it.
+    //
+    void ClusterBoth (const TagBoxArray& tags, const BoxList& pnd,
+                      BoxList& distributed, BoxList& gathered) const
+    {
+        ClusterTagsDistributed(tags, pnd, distributed);
+
+        std::vector<IntVect> tagvec;
+        tags.collate(tagvec);
+        gathered.clear();
+        if (tagvec.size() > 0)
+        {
+            ClusterList clist(&tagvec[0], tagvec.size());
+            clist.chop(grid_eff);
+            BoxDomain bd;
+            bd.add(pnd);
+            clist.intersect(bd);
+            clist.boxList(gathered);
+        }
+    }
+
+    Real gridEff () const { return grid_eff; }
+};
+
+//
+// The smallest fraction of tagged cells in a box of bl, and the number of
+// tags outside bl.
+//
+static
+Real
+MinEff (const BoxList& bl, const std::vector<IntVect>& tagvec, long& nuncovered)
+{
+    const BoxArray ba(bl);
+    Array<long> cnt(ba.size(), 0);
+    std::vector< std::pair<int,Box> > isects;
+    nuncovered = 0;
+    for (const IntVect& iv : tagvec) {
+        ba.intersections(Box(iv,iv), isects);
+        if (isects.empty()) ++nuncovered;
+        for (const auto& isec : isects) ++cnt[isec.first];
+    }
+    Real eff = 1.0;
+    for (int i = 0; i < ba.size(); ++i) {
+        eff = std::min(eff, Real(cnt[i]) / Real(ba[i].numPts()));
+    }
+    return eff;
+}
+
+//
+// Set the tags on grids grown by four, ghost cells too, and coarsen them
+// by two, as MakeNewGrids has them after buffering and coarsening, so the
+// grids overlap.  Cluster them both ways, in a proper nesting domain that
+// leaves out a corner, and check the distributed boxes.  Returns the
+// number of failures.
+//
+static
+int
+CheckDistributed (bool compress)
+{
+    Mesh mesh(compress, true);
+    const Geometry& gm = mesh.Geom(0);
+    const Box& domain = gm.Domain();
+    const Real* dx = gm.CellSize();
+
+    BoxArray ba(domain);
+    ba.maxSize(16);
+    DistributionMapping dm(ba);
+    TagBoxArray tags(ba, dm, 4);
+    for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+    {
+        TagBox& tagfab = tags[mfi];
+        const Box& bx = tagfab.box() & domain;
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+        {
+            Real x[BL_SPACEDIM];
+            for (int d = 0; d < BL_SPACEDIM; ++d) {
+                x[d] = gm.ProbLo(d) + (iv[d] + 0.5) * dx[d] - 0.5;
+            }
+            if (Tagged(x, dx)) {
+                tagfab(iv) = TagBox::SET;
+            }
+        }
+    }
+    tags.coarsen(IntVect(AMREX_D_DECL(2,2,2)));
+
+    const Box cdomain = amrex::coarsen(domain, 2);
+    const Box corner(cdomain.smallEnd(), cdomain.smallEnd() + cdomain.size()/2 - 1);
+    const BoxList pnd = amrex::complementIn(cdomain, BoxList(corner));
+    tags.setVal(BoxList(corner), TagBox::CLEAR);
+
+    BoxList distributed, gathered;
+    mesh.ClusterBoth(tags, pnd, distributed, gathered);
+
+    std::vector<IntVect> tagvec;
+    tags.collate(tagvec);
+
+    long nuncovered_d, nuncovered_g;
+    const Real eff_d = MinEff(distributed, tagvec, nuncovered_d);
+    const Real eff_g = MinEff(gathered, tagvec, nuncovered_g);
+
+    const BoxArray dba(distributed), gba(gathered), pnba(pnd);
+    bool nested = true;
+    for (int i = 0; i < dba.size(); ++i) {
+        if (!pnba.contains(dba[i])) nested = false;
+    }
+
+    amrex::Print() << "compress_tags " << compress << ", " << tagvec.size() << " tags: "
+                   << dba.size() << " distributed boxes, " << dba.numPts() << " cells, "
+                   << "efficiency " << eff_d << "; "
+                   << gba.size() << " gathered boxes, " << gba.numPts() << " cells, "
+                   << "efficiency " << eff_g << "\n";
+
+    int nfail = 0;
+    if (!distributed.isDisjoint() || !nested || nuncovered_d != 0) {
+        amrex::Print() << "    distributed boxes overlap, are not nested or miss "
+                       << nuncovered_d << " tags\n";
+        ++nfail;
+    }
+    if (eff_d < std::min(mesh.gridEff(), eff_g)) {
+        amrex::Print() << "    distributed boxes below grid_eff\n";
+        ++nfail;
+    }
+    if (dba.numPts() > 1.25*gba.numPts()) ++nfail;
+    if (ParallelDescriptor::NProcs() == 1 && !dba.contains(gba))
+    {
+        amrex::Print() << "    not merged from the gathered boxes on one process\n";
+        ++nfail;
+    }
+    return nfail;
+}
+
+int
+main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    int nfail = 0;
+
+    for (int distributed = 0; distributed < 2; ++distributed)
+    {
+        Mesh plain(false, distributed);
+        Mesh compressed(true, distributed);
+
+        plain.InitFromScratch(0.0);
+        compressed.InitFromScratch(0.0);
+
+        bool same = (plain.finestLevel() == compressed.finestLevel());
+        for (int lev = 0; same && lev <= plain.finestLevel(); ++lev)
+        {
+            const BoxArray& ba = plain.boxArray(lev);
+            amrex::Print() << "distributed_clustering " << distributed << " level " << lev
+                           << ": " << ba.size() << " grids, " << ba.numPts() << " cells\n";
+            same = (ba == compressed.boxArray(lev));
+        }
+
+        if (!same) {
+            amrex::Print() << "distributed_clustering " << distributed
+                           << ": the grids differ with compress_tags\n";
+            ++nfail;
+        }
+
+        for (int lev = 1; lev <= plain.finestLevel(); ++lev)
+        {
+            BoxArray cba = plain.boxArray(lev);
+            cba.coarsen(plain.refRatio(lev-1));
+            BoxList bl;
+            for (int i = 0; i < cba.size(); ++i) {
+                const Box& b = amrex::grow(cba[i], 1) & plain.Geom(lev-1).Domain();
+                bl.push_back(b);
+            }
+            if (!plain.boxArray(lev-1).contains(BoxArray(bl))) {
+                amrex::Print() << "distributed_clustering " << distributed << " level " << lev
+                               << ": not properly nested\n";
+                ++nfail;
+            }
+        }
+    }
+
+    for (int compress = 0; compress < 2; ++compress)
+    {
+        nfail += CheckDistributed(compress);
+    }
+
+    amrex::Print() << (nfail == 0 ? "PASSED" : "FAILED") << "\n";
+
+    amrex::Finalize();
+}
@@ -163,6 +163,10 @@ if (ENABLE_OMP)
    append ( OpenMP_CXX_FLAGS AMREX_EXTRA_CXX_FLAGS )
 endif()
 
+# VisMF's asynchronous writer uses std::thread
+find_package (Threads REQUIRED)
+list (APPEND AMREX_EXTRA_CXX_LINK_LINE "${CMAKE_THREAD_LIBS_INIT}")
+
 
 # ------------------------------------------------------------- #
 #    Setup compiler flags 
@@ -287,6 +287,8 @@ AmrLevelAdv::advance (Real time,
 
 	for (MFIter mfi(S_new, true); mfi.isValid(); ++mfi)
 	{
+	    const Real wt = ParallelDescriptor::second();
+
 	    const Box& bx = mfi.tilebox();
 
 	    const FArrayBox& statein = Sborder[mfi];
@@ -324,6 +326,8 @@ AmrLevelAdv::advance (Real time,
 		for (int i = 0; i < BL_SPACEDIM ; i++)
 		    fluxes[i][mfi].copy(flux[i],mfi.nodaltilebox(i));
 	    }
+
+	    addBoxCost(mfi.index(), ParallelDescriptor::second() - wt);
 	}
     }
 
@@ -347,6 +351,17 @@ AmrLevelAdv::advance (Real time,
     return dt;
 }
 
+#ifdef PARTICLES
+Array<long>
+AmrLevelAdv::NumberOfParticlesInGrid () const
+{
+    if (TracerPC) {
+        return TracerPC->NumberOfParticlesInGrid(level, true, true);
+    }
+    return Array<long>();
+}
+#endif
+
 //
 //Estimate time step.
 //
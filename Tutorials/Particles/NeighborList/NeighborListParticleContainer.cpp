@@ -84,13 +84,13 @@ void NeighborListParticleContainer::computeForces() {
     }
 }
 
-void NeighborListParticleContainer::computeForcesNL() {
+void NeighborListParticleContainer::computeForcesNL(bool build_list) {
 
     BL_PROFILE("NeighborListParticleContainer::computeForcesNL");
 
     const int lev = 0;
 
-    buildNeighborList(lev);
+    if (build_list) buildNeighborList(lev);
 
 #ifdef _OPENMP
 #pragma omp parallel
@@ -22,6 +22,10 @@ int main(int argc, char* argv[])
     pp.get("dt", dt);
     pp.get("do_nl", do_nl);
 
+    // with a skin > 0 the neighbor list is a Verlet list
+    Real skin = 0.0;
+    pp.query("skin", skin);
+
     RealBox real_box;
     for (int n = 0; n < BL_SPACEDIM; n++) {
         real_box.setLo(n, 0.0);
@@ -48,19 +52,32 @@ int main(int argc, char* argv[])
     myPC.InitParticles();
 
     const int lev = 0;
+    const bool verlet = do_nl && skin > 0.0;
+
+    if (verlet) myPC.setVerletSkin(skin);
 
     for (int i = 0; i < max_step; i++) {
         if (write_particles) myPC.writeParticles(i);
-        
-        myPC.fillNeighbors(lev);
 
-        if (do_nl) { myPC.computeForcesNL(); } 
-        else {       myPC.computeForces();   }
+        if (verlet) {
+            myPC.updateNeighborList(lev);
+            myPC.computeForcesNL(false);
+        } else {
+            myPC.fillNeighbors(lev);
 
-        myPC.clearNeighbors(lev);
+            if (do_nl) { myPC.computeForcesNL(); } 
+            else {       myPC.computeForces();   }
+
+            myPC.clearNeighbors(lev);
+        }
 
         myPC.moveParticles(dt);
 
+        if (!verlet) myPC.Redistribute();
+    }
+
+    if (verlet) {
+        myPC.clearNeighbors(lev);
         myPC.Redistribute();
     }
 